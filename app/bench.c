@@ -0,0 +1,107 @@
+/**
+ * @file
+ *
+ * Helpers shared by the benchmark exports.
+ */
+
+#include "bench.h"
+#include "bench_msg.h"
+#include "export.h"
+#include "ratelimit.h"
+#include "timer.h"
+
+/* Longest name kept in the result message and printed */
+#define BENCH_NAME_MAX (32)
+
+/* name, ": ", ticks, " ticks, ", bytes, " bytes\n" */
+#define BENCH_LINE_MAX (BENCH_NAME_MAX + 2 + 10 + 8 + 10 + 7)
+
+/* 20 reports per second after a burst of 16, a benchmark prints a few */
+RATELIMIT(bench_reports, "bench", 20, 16);
+
+/*
+ * Last result as a bench_result message (app/bench.msg), the host reads it in
+ * place through the generated bench_msg.py.
+ */
+u32 bench_last[(BENCH_RESULT_SIZE + BENCH_NAME_MAX + 3) / 4];
+
+static void bench_record(const char *name, u32 ticks, u32 bytes)
+{
+	struct bench_result *msg = (struct bench_result *)bench_last;
+	u32 used = BENCH_RESULT_SIZE;
+	u32 len = 0;
+	u8 *tail;
+
+	while (len < BENCH_NAME_MAX && '\0' != name[len]) {
+		len++;
+	}
+	tail = bench_result_name_init(msg, &used, len);
+	for (u32 i = 0; i < len; i++) {
+		tail[i] = name[i];
+	}
+	msg->ticks = ticks;
+	msg->bytes = bytes;
+	msg->seq++;
+}
+
+/* appends 'str' to the report line at 'len', up to 'max' bytes */
+static u32 bench_put(char *line, u32 len, const char *str, u32 max)
+{
+	for (; '\0' != *str && max > 0; str++, max--) {
+		line[len++] = *str;
+	}
+
+	return len;
+}
+
+/* appends 'value' in decimal to the report line at 'len' */
+static u32 bench_putDec(char *line, u32 len, u32 value)
+{
+	char digits[10];
+	int n = 0;
+
+	do {
+		digits[n++] = '0' + value % 10;
+		value /= 10;
+	} while (0 != value);
+
+	while (n > 0) {
+		line[len++] = digits[--n];
+	}
+
+	return len;
+}
+
+/**
+ * @return current value of the export timer, it counts down
+ */
+u32 bench_now(void) { return timer_getValue(EXPORT_TIMER_NR, EXPORT_TIMER_CTR); }
+
+/**
+ * Prints "<name>: <ticks> ticks[, <bytes> bytes]" to the benchmark UART and
+ * keeps it in bench_last. The line goes through a rate limiter, a host
+ * calling the benchmarks in a loop (e.g. over RPC) would otherwise hold the
+ * UART; bench_last is always updated.
+ *
+ * @param name - what has been measured
+ * @param ticks - elapsed ticks, i.e. (start - end) of bench_now()
+ * @param bytes - bytes processed, 0 if not applicable
+ */
+void bench_report(const char *name, u32 ticks, u32 bytes)
+{
+	char line[BENCH_LINE_MAX];
+	u32 len;
+
+	len = bench_put(line, 0, name, BENCH_NAME_MAX);
+	len = bench_put(line, len, ": ", 2);
+	len = bench_putDec(line, len, ticks);
+	len = bench_put(line, len, " ticks", 6);
+	if (0 != bytes) {
+		len = bench_put(line, len, ", ", 2);
+		len = bench_putDec(line, len, bytes);
+		len = bench_put(line, len, " bytes", 6);
+	}
+	len = bench_put(line, len, "\n", 1);
+	ratelimit_write(&bench_reports, BENCH_UART, line, len);
+	bench_record(name, ticks, bytes);
+}
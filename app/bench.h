@@ -0,0 +1,20 @@
+/**
+ * @file
+ *
+ * Helpers shared by the benchmark exports. Benchmarks are exported like any
+ * other function (add them to PIC_EXPORTS) and report over UART0, times are
+ * in ticks of the export timer (1 MHz).
+ */
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <types.h>
+
+#define BENCH_UART (0)
+
+u32 bench_now(void);
+
+void bench_report(const char *name, u32 ticks, u32 bytes);
+
+#endif /* _BENCH_H_ */
@@ -0,0 +1,132 @@
+/**
+ * @file
+ *
+ * Sustained audio streaming through the AACI: a tone source, the PCM
+ * conversion stage and the AACI sink, polled by the thread. The stream
+ * lasts NR_FRAMES / AACI_RATE seconds whatever the CPU does, the ticks the
+ * sink spent waiting for room in the ring are the CPU headroom, the rest is
+ * the cost of producing and moving the samples.
+ */
+
+#include <stddef.h>
+
+#include "aaci.h"
+#include "bench.h"
+#include "phase.h"
+#include "pipeline.h"
+
+/* 250 ms of audio */
+#define NR_FRAMES (AACI_RATE / 4)
+
+/* a 1 kHz triangle, samples per half period */
+#define TONE_HALF (AACI_RATE / 2000)
+#define TONE_STEP (0x4000 / TONE_HALF)
+
+#define BLOCK_SIZE	 (512)
+#define NR_TONE_BUFS (8)
+#define NR_PCM_BUFS	 (24)
+#define NR_SLOTS	 (8)
+
+/* Context of the tone source */
+struct tone {
+	struct pool *pool;
+	u32 left;  /* samples still to be produced */
+	u32 phase; /* sample index within the period */
+};
+
+static u8 tone_mem[POOL_MEM_SIZE(BLOCK_SIZE, NR_TONE_BUFS)] PHASE_BSS(bench_aaci)
+	__attribute__((aligned(4)));
+static u8 pcm_mem[POOL_MEM_SIZE(BLOCK_SIZE, NR_PCM_BUFS)] PHASE_BSS(bench_aaci)
+	__attribute__((aligned(4)));
+static struct buf *slots[2][NR_SLOTS] PHASE_BSS(bench_aaci);
+
+/*
+ * Source stage, fills buffers of the tone's pool with signed 16-bit mono
+ * samples until 'left' is exhausted.
+ */
+static u32 bench_tone(struct stage *st, struct buf **bufs, u32 n)
+{
+	struct tone *ctx = st->ctx;
+	u32 bytes = 0;
+	u32 k, i;
+	s16 *s;
+
+	(void)bufs;
+	for (; n > 0 && 0 != ctx->left; --n) {
+		struct buf *buf = buf_alloc(ctx->pool);
+
+		if (NULL == buf) {
+			break;
+		}
+		k = buf_tailroom(buf) / 2;
+		k = (k < ctx->left ? k : ctx->left);
+		s = (s16 *)buf_put(buf, k * 2);
+		for (i = 0; i < k; i++, ctx->phase++) {
+			if (2 * TONE_HALF == ctx->phase) {
+				ctx->phase = 0;
+			}
+			s[i] = (s16)(ctx->phase < TONE_HALF
+							 ? -0x2000 + ctx->phase * TONE_STEP
+							 : 0x2000 - (ctx->phase - TONE_HALF) * TONE_STEP);
+		}
+		ctx->left -= k;
+		bytes += k * 2;
+		stage_emit(st, buf);
+	}
+
+	return bytes;
+}
+
+/**
+ * Streams NR_FRAMES of a tone and reports the total, busy and idle ticks,
+ * the bytes are those of the AACI frames.
+ *
+ * @return 0, or -1 if the FIFO ran empty while streaming or frames got lost
+ */
+int bench_aaci(void)
+{
+	struct pool tone_pool, pcm_pool;
+	struct buf_queue q[2];
+	struct tone tone = {&tone_pool, NR_FRAMES, 0};
+	struct pcm_stage pcm = {&pcm_pool, PIPELINE_PCM_S16, 0};
+	struct aaci_stage sink = {0};
+	struct stage src_st, pcm_st, sink_st;
+	struct pipeline p;
+	struct aaci_stats stats;
+	u32 start, total;
+
+	phase_enter(bench_aaci);
+	pool_init(&tone_pool, PHASE_ACCESS(bench_aaci, tone_mem), BLOCK_SIZE,
+			  NR_TONE_BUFS);
+	pool_init(&pcm_pool, PHASE_ACCESS(bench_aaci, pcm_mem), BLOCK_SIZE,
+			  NR_PCM_BUFS);
+	buf_queue_init(&q[0], PHASE_ACCESS(bench_aaci, slots)[0], NR_SLOTS);
+	buf_queue_init(&q[1], PHASE_ACCESS(bench_aaci, slots)[1], NR_SLOTS);
+	stage_init(&src_st, "tone", bench_tone, &tone, NULL, &q[0]);
+	stage_init(&pcm_st, "pcm", pipeline_pcm, &pcm, &q[0], &q[1]);
+	stage_init(&sink_st, "aaci", pipeline_aaci_sink, &sink, &q[1], NULL);
+	pipeline_init(&p);
+	pipeline_add(&p, &src_st);
+	pipeline_add(&p, &pcm_st);
+	pipeline_add(&p, &sink_st);
+
+	aaci_init();
+
+	start = bench_now();
+	while (pipeline_step(&p)) {
+		/* an empty loop */
+	}
+	aaci_drain();
+	total = start - bench_now();
+
+	bench_report("aaci stream", total, NR_FRAMES * 4);
+	bench_report("aaci busy", total - sink.wait, NR_FRAMES * 4);
+	bench_report("aaci idle", sink.wait, 0);
+
+	aaci_getStats(&stats);
+
+	return (0 == stats.underruns && NR_FRAMES == stats.frames &&
+					0 == pcm.dropped
+				? 0
+				: -1);
+}
@@ -0,0 +1,94 @@
+/**
+ * @file
+ *
+ * Hex and base64 encoder benchmark against a per nibble encoder. Cycles per
+ * byte are ticks * (CPU clock / 1 MHz) / bytes.
+ */
+
+#include "bench.h"
+#include "codec.h"
+#include "phase.h"
+
+#define NR_BYTES (2048)
+
+static u8 data[NR_BYTES] PHASE_BSS(bench_codec) __attribute__((aligned(4)));
+static char text[HEX_LEN(NR_BYTES)] PHASE_BSS(bench_codec)
+	__attribute__((aligned(4)));
+static u8 back[NR_BYTES] PHASE_BSS(bench_codec);
+
+static void hex_nibbles(char *dst, const u8 *src, u32 len)
+{
+	static const char digits[] = "0123456789abcdef";
+	u32 i;
+
+	for (i = 0; i < len; i++) {
+		*dst++ = digits[src[i] >> 4];
+		*dst++ = digits[src[i] & 15];
+	}
+}
+
+static int compare(const u8 *a, const u8 *b, u32 len)
+{
+	u32 i;
+
+	for (i = 0; i < len; i++) {
+		if (a[i] != b[i]) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Encodes NR_BYTES to hex per nibble and with the tables, then to base64,
+ * and decodes both back.
+ *
+ * @return 0, or -1 if a round trip does not restore the data
+ */
+int bench_codec(void)
+{
+	u32 start, n;
+	u8 *d;
+	u32 i;
+
+	phase_enter(bench_codec);
+	d = PHASE_ACCESS(bench_codec, data);
+	for (i = 0; i < NR_BYTES; i++) {
+		d[i] = (u8)(i * 2654435761u >> 24);
+	}
+
+	start = bench_now();
+	hex_nibbles(PHASE_ACCESS(bench_codec, text),
+				PHASE_ACCESS(bench_codec, data), NR_BYTES);
+	bench_report("hex nibbles", start - bench_now(), NR_BYTES);
+
+	start = bench_now();
+	n = hex_encode(PHASE_ACCESS(bench_codec, text),
+				   PHASE_ACCESS(bench_codec, data), NR_BYTES);
+	bench_report("hex encode", start - bench_now(), NR_BYTES);
+
+	start = bench_now();
+	n = hex_decode(PHASE_ACCESS(bench_codec, back),
+				   PHASE_ACCESS(bench_codec, text), n);
+	bench_report("hex decode", start - bench_now(), NR_BYTES);
+	if (NR_BYTES != n || 0 != compare(PHASE_ACCESS(bench_codec, data),
+									  PHASE_ACCESS(bench_codec, back),
+									  NR_BYTES)) {
+		return -1;
+	}
+
+	start = bench_now();
+	n = base64_encode(PHASE_ACCESS(bench_codec, text),
+					  PHASE_ACCESS(bench_codec, data), NR_BYTES);
+	bench_report("base64 encode", start - bench_now(), NR_BYTES);
+
+	start = bench_now();
+	n = base64_decode(PHASE_ACCESS(bench_codec, back),
+					  PHASE_ACCESS(bench_codec, text), n);
+	bench_report("base64 decode", start - bench_now(), NR_BYTES);
+
+	return (NR_BYTES == n ? compare(PHASE_ACCESS(bench_codec, data),
+									PHASE_ACCESS(bench_codec, back), NR_BYTES)
+						  : -1);
+}
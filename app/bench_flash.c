@@ -0,0 +1,102 @@
+/**
+ * @file
+ *
+ * Flash log benchmark on the last sectors of the NOR flash (QEMU needs
+ * -pflash with a 64 MiB file). Appends only stage the records, the polls
+ * interleaved with them program and erase the flash: the append ticks are
+ * what the payload's real-time work pays, the poll ticks the CPU time the
+ * flash costs, the total the time until everything is in the flash.
+ */
+
+#include <stddef.h>
+
+#include "bench.h"
+#include "bsp.h"
+#include "cfi_flash.h"
+#include "flashlog.h"
+#include "phase.h"
+
+#define NR_SECTORS (4)
+#define NR_RECORDS (512)
+#define REC_LEN	   (120)
+#define RING_SIZE  (8192)
+
+static u8 ring[RING_SIZE] PHASE_BSS(bench_flash);
+static u8 rec[REC_LEN] PHASE_BSS(bench_flash);
+
+/* polls the log once, adds the ticks it took to '*ticks' */
+static int bench_poll(struct flashlog *log, u32 *ticks)
+{
+	u32 start = bench_now();
+	int r = flashlog_poll(log);
+
+	*ticks += start - bench_now();
+
+	return r;
+}
+
+/**
+ * Appends NR_RECORDS records of REC_LEN bytes with a poll after each, then
+ * polls until they are written and reads the last one back.
+ *
+ * @return 0, or -1 if there is no flash, an operation failed or the last
+ * record does not read back
+ */
+int bench_flash(void)
+{
+	struct cfi_flash flash;
+	struct flashlog log;
+	struct flashlog_cursor c;
+	u32 start, appends, polls, total;
+	u32 i, t, last;
+	u8 type;
+	u8 *p;
+	int r;
+
+	phase_enter(bench_flash);
+	if (0 != cfi_flash_probe(&flash, BSP_FLASH_BASE_ADDRESS) ||
+		0 != flashlog_init(&log, &flash,
+						   flash.size - NR_SECTORS * flash.sector_size,
+						   NR_SECTORS, PHASE_ACCESS(bench_flash, ring),
+						   RING_SIZE) ||
+		0 != flashlog_mount(&log)) {
+		return -1;
+	}
+
+	appends = 0;
+	polls = 0;
+	start = bench_now();
+	for (i = 0; i < NR_RECORDS; i++) {
+		p = PHASE_ACCESS(bench_flash, rec);
+		p[0] = (u8)i;
+		p[REC_LEN - 1] = (u8)(i >> 8);
+		t = bench_now();
+		r = flashlog_append(&log, (u8)i, p, REC_LEN);
+		appends += t - bench_now();
+		/* the ring is full, the flash must catch up */
+		while (FLASHLOG_EFULL == r) {
+			bench_poll(&log, &polls);
+			r = flashlog_append(&log, (u8)i, PHASE_ACCESS(bench_flash, rec),
+								REC_LEN);
+		}
+		bench_poll(&log, &polls);
+	}
+	while (FLASHLOG_BUSY == bench_poll(&log, &polls)) {
+		/* an empty loop */
+	}
+	total = start - bench_now();
+
+	bench_report("flashlog append", appends, NR_RECORDS * REC_LEN);
+	bench_report("flashlog poll", polls, NR_RECORDS * REC_LEN);
+	bench_report("flashlog total", total, NR_RECORDS * REC_LEN);
+
+	/* the last record comes last */
+	last = NR_RECORDS;
+	flashlog_rewind(&log, &c);
+	p = PHASE_ACCESS(bench_flash, rec);
+	while (REC_LEN == flashlog_next(&log, &c, &type, p, REC_LEN)) {
+		last = p[0] | p[REC_LEN - 1] << 8;
+	}
+
+	return (0 == log.errors && NR_RECORDS - 1 == last ? 0 : -1);
+}
@@ -0,0 +1,97 @@
+/**
+ * @file
+ *
+ * Benchmark of specialized (jit.h) against generic kernels.
+ */
+
+#include <stddef.h>
+
+#include "bench.h"
+#include "arena.h"
+#include "jit.h"
+#include "phase.h"
+
+#define NR_TAPS	   (16)
+#define NR_SAMPLES (1024)
+
+static const s16 taps[NR_TAPS] = {
+	-3, 0, 12, -48, 0, 160, -512, 1024, 1024, -512, 160, 0, -48, 12, 0, -3,
+};
+
+static s16 samples[NR_SAMPLES + NR_TAPS] PHASE_BSS(bench_jit);
+static s32 out_generic[NR_SAMPLES] PHASE_BSS(bench_jit);
+static s32 out_jit[NR_SAMPLES] PHASE_BSS(bench_jit);
+
+/* generated code, see jit_init() */
+static u32 code[1024] PHASE_BSS(bench_jit) __attribute__((aligned(32)));
+
+static s32 fir_generic(const s16 *x, const s16 *coef, u32 ntaps)
+{
+	s32 acc = 0;
+	u32 i;
+
+	for (i = 0; i < ntaps; i++) {
+		acc += coef[i] * x[i];
+	}
+
+	return acc;
+}
+
+/**
+ * Filters NR_SAMPLES samples with the generic and with the specialized FIR
+ * kernel and reports both times.
+ *
+ * @return 0, or -1 if the results differ
+ */
+int bench_jit(void)
+{
+	struct arena arena;
+	struct jit_cache cache;
+	jit_fir_fn fir;
+	u32 i, start;
+	s16 *x;
+	s32 *y, *z;
+
+	phase_enter(bench_jit);
+	x = PHASE_ACCESS(bench_jit, samples);
+	for (i = 0; i < NR_SAMPLES + NR_TAPS; i++) {
+		x[i] = (s16)(i * 2654435761u >> 16);
+	}
+
+	arena_init(&arena, PHASE_ACCESS(bench_jit, code), sizeof(code));
+	jit_init(&cache, &arena);
+
+	start = bench_now();
+	fir = jit_fir(&cache, taps, NR_TAPS);
+	bench_report("fir specialize", start - bench_now(), 0);
+	if (NULL == fir) {
+		return -1;
+	}
+
+	x = PHASE_ACCESS(bench_jit, samples);
+	y = PHASE_ACCESS(bench_jit, out_generic);
+	start = bench_now();
+	for (i = 0; i < NR_SAMPLES; i++) {
+		y[i] = fir_generic(&x[i], taps, NR_TAPS);
+	}
+	bench_report("fir generic", start - bench_now(), NR_SAMPLES * sizeof(s16));
+
+	x = PHASE_ACCESS(bench_jit, samples);
+	z = PHASE_ACCESS(bench_jit, out_jit);
+	start = bench_now();
+	for (i = 0; i < NR_SAMPLES; i++) {
+		z[i] = fir(&x[i]);
+	}
+	bench_report("fir specialized", start - bench_now(),
+				 NR_SAMPLES * sizeof(s16));
+
+	y = PHASE_ACCESS(bench_jit, out_generic);
+	z = PHASE_ACCESS(bench_jit, out_jit);
+	for (i = 0; i < NR_SAMPLES; i++) {
+		if (y[i] != z[i]) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file
+ *
+ * Memo cache benchmark: SHA-256 digests of NR_INPUTS blocks, computed, then
+ * through the cache missing and hitting. A hit costs the xxh32 of the block
+ * and the copy of the digest.
+ */
+
+#include "bench.h"
+#include "memo.h"
+#include "phase.h"
+#include "sha256.h"
+
+#define NR_INPUTS (8)
+#define INPUT_LEN (512)
+
+/* every entry keeps its input for the compare on a hit */
+MEMO(memo_sha256, "sha256", 16,
+	 NR_INPUTS * (INPUT_LEN + SHA256_DIGEST_SIZE));
+
+static u8 data[NR_INPUTS][INPUT_LEN] PHASE_BSS(bench_memo)
+	__attribute__((aligned(4)));
+
+/* sha256() through the cache */
+static void bench_sha256Memo(const void *in, u32 len, u8 *digest)
+{
+	struct memo_key k = {.in = in, .len = len};
+	s32 ret;
+
+	memo_hash(&k);
+	if (MEMO_MISS == memo_get(&memo_sha256, &k, &ret, digest,
+							  SHA256_DIGEST_SIZE)) {
+		sha256(in, len, digest);
+		memo_put(&memo_sha256, &k, 0, digest, SHA256_DIGEST_SIZE);
+	}
+}
+
+/**
+ * Hashes the blocks directly, through an empty cache and again through the
+ * filled cache.
+ *
+ * @return 0, or -1 if a cached digest differs or a hit missed
+ */
+int bench_memo(void)
+{
+	u8 digest[NR_INPUTS][SHA256_DIGEST_SIZE];
+	u8 cached[SHA256_DIGEST_SIZE];
+	u8(*d)[INPUT_LEN];
+	u32 start, i, j;
+
+	phase_enter(bench_memo);
+	d = PHASE_ACCESS(bench_memo, data);
+	for (i = 0; i < NR_INPUTS; i++) {
+		for (j = 0; j < INPUT_LEN; j++) {
+			d[i][j] = (u8)((i * INPUT_LEN + j) * 2654435761u >> 24);
+		}
+	}
+	memo_reset(&memo_sha256);
+
+	start = bench_now();
+	for (i = 0; i < NR_INPUTS; i++) {
+		sha256(PHASE_ACCESS(bench_memo, data)[i], INPUT_LEN, digest[i]);
+	}
+	bench_report("sha256", start - bench_now(), NR_INPUTS * INPUT_LEN);
+
+	start = bench_now();
+	for (i = 0; i < NR_INPUTS; i++) {
+		bench_sha256Memo(PHASE_ACCESS(bench_memo, data)[i], INPUT_LEN, cached);
+	}
+	bench_report("memo miss", start - bench_now(), NR_INPUTS * INPUT_LEN);
+
+	start = bench_now();
+	for (i = 0; i < NR_INPUTS; i++) {
+		bench_sha256Memo(PHASE_ACCESS(bench_memo, data)[i], INPUT_LEN, cached);
+		for (j = 0; j < SHA256_DIGEST_SIZE; j++) {
+			if (cached[j] != digest[i][j]) {
+				return -1;
+			}
+		}
+	}
+	bench_report("memo hit", start - bench_now(), NR_INPUTS * INPUT_LEN);
+
+	return (NR_INPUTS == memo_sha256.hits ? 0 : -1);
+}
@@ -0,0 +1,96 @@
+/**
+ * @file
+ *
+ * Benchmark of the word at a time byte searches (scan.h) against byte loops.
+ * Cycles per byte are ticks * (CPU clock / 1 MHz) / bytes.
+ */
+
+#include <stddef.h>
+
+#include "bench.h"
+#include "phase.h"
+#include "scan.h"
+
+#define NR_BYTES (4096)
+
+static char text[NR_BYTES + 1] PHASE_BSS(bench_scan) __attribute__((aligned(4)));
+
+static u32 strlen_bytes(const char *str)
+{
+	const char *p = str;
+
+	for (; '\0' != *p; ++p) {
+		/* an empty loop */
+	}
+
+	return p - str;
+}
+
+static u32 count_bytes(const char *buf, u32 len, char c)
+{
+	u32 n = 0;
+	u32 i;
+
+	for (i = 0; i < len; i++) {
+		n += (buf[i] == c);
+	}
+
+	return n;
+}
+
+/**
+ * Times strlen, memchr and count over NR_BYTES of text, with byte loops and
+ * with the scan kernels.
+ *
+ * @return 0, or -1 if the results differ
+ */
+int bench_scan(void)
+{
+	static const u8 delims[] = {'\r', '\t', '\0'};
+	u32 start, a, b;
+	const void *hit;
+	char *t;
+	u32 i;
+
+	phase_enter(bench_scan);
+	t = PHASE_ACCESS(bench_scan, text);
+	for (i = 0; i < NR_BYTES; i++) {
+		/* printable, a line feed every 61 bytes */
+		t[i] = (0 == i % 61 ? '\n' : ' ' + (i * 2654435761u >> 24) % 95);
+	}
+	t[NR_BYTES] = '\0';
+
+	start = bench_now();
+	a = strlen_bytes(PHASE_ACCESS(bench_scan, text));
+	bench_report("strlen bytes", start - bench_now(), NR_BYTES);
+	start = bench_now();
+	b = scan_strlen(PHASE_ACCESS(bench_scan, text));
+	bench_report("strlen scan", start - bench_now(), NR_BYTES);
+	if (a != b) {
+		return -1;
+	}
+
+	start = bench_now();
+	hit = scan_memchr(PHASE_ACCESS(bench_scan, text), '\r', NR_BYTES);
+	bench_report("memchr scan", start - bench_now(), NR_BYTES);
+	if (NULL != hit) {
+		return -1;
+	}
+
+	start = bench_now();
+	a = count_bytes(PHASE_ACCESS(bench_scan, text), NR_BYTES, '\n');
+	bench_report("count bytes", start - bench_now(), NR_BYTES);
+	start = bench_now();
+	b = scan_count(PHASE_ACCESS(bench_scan, text), NR_BYTES, '\n');
+	bench_report("count scan", start - bench_now(), NR_BYTES);
+	if (a != b) {
+		return -1;
+	}
+
+	start = bench_now();
+	a = scan_find_any(PHASE_ACCESS(bench_scan, text), NR_BYTES, delims,
+					  sizeof(delims));
+	bench_report("find any scan", start - bench_now(), NR_BYTES);
+
+	return (NR_BYTES == a ? 0 : -1);
+}
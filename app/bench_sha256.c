@@ -0,0 +1,56 @@
+/**
+ * @file
+ *
+ * SHA-256 benchmark. Cycles per byte are ticks * (CPU clock / 1 MHz) / bytes.
+ */
+
+#include "bench.h"
+#include "phase.h"
+#include "sha256.h"
+
+#define NR_BYTES (4096)
+
+static u8 data[NR_BYTES] PHASE_BSS(bench_sha256) __attribute__((aligned(4)));
+
+/* SHA-256("abc"), FIPS 180-4 example */
+static const u8 abc_digest[SHA256_DIGEST_SIZE] = {
+	0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40,
+	0xde, 0x5d, 0xae, 0x22, 0x23, 0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17,
+	0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad,
+};
+
+/**
+ * Checks the "abc" test vector, then hashes NR_BYTES aligned and unaligned.
+ *
+ * @return 0, or -1 if the test vector does not match
+ */
+int bench_sha256(void)
+{
+	u8 digest[SHA256_DIGEST_SIZE];
+	u32 start;
+	u8 *d;
+	u32 i;
+
+	phase_enter(bench_sha256);
+	sha256("abc", 3, digest);
+	for (i = 0; i < SHA256_DIGEST_SIZE; i++) {
+		if (digest[i] != abc_digest[i]) {
+			return -1;
+		}
+	}
+
+	d = PHASE_ACCESS(bench_sha256, data);
+	for (i = 0; i < NR_BYTES; i++) {
+		d[i] = (u8)(i * 2654435761u >> 24);
+	}
+
+	start = bench_now();
+	sha256(PHASE_ACCESS(bench_sha256, data), NR_BYTES, digest);
+	bench_report("sha256", start - bench_now(), NR_BYTES);
+
+	start = bench_now();
+	sha256(PHASE_ACCESS(bench_sha256, data) + 1, NR_BYTES - 1, digest);
+	bench_report("sha256 unaligned", start - bench_now(), NR_BYTES - 1);
+
+	return 0;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file
+ *
+ * UART transmit and loopback benchmarks. Build once with and once without
+ * PIC_MMU to compare strongly ordered against buffered register stores.
+ */
+
+#include "bench.h"
+#include "phase.h"
+#include "uart.h"
+
+/* the loopback UART, the benchmark UART stays untouched */
+#define LOOP_UART (1)
+#define NR_BYTES  (1024)
+
+static u8 tx[NR_BYTES] PHASE_BSS(bench_uart);
+static u8 rx[NR_BYTES] PHASE_BSS(bench_uart);
+
+/**
+ * Transmits NR_BYTES over LOOP_UART, first without and then with loopback
+ * reading every byte back, and reports both times.
+ *
+ * @return 0, or -1 if a byte did not come back unchanged
+ */
+int bench_uart(void)
+{
+	u32 start;
+	u32 i, n;
+	u8 *t, *r;
+
+	phase_enter(bench_uart);
+	t = PHASE_ACCESS(bench_uart, tx);
+	for (i = 0; i < NR_BYTES; i++) {
+		t[i] = (u8)i;
+	}
+	uart_init(LOOP_UART);
+
+	start = bench_now();
+	uart_write(LOOP_UART, PHASE_ACCESS(bench_uart, tx), NR_BYTES);
+	bench_report("uart tx", start - bench_now(), NR_BYTES);
+
+	uart_enableLoopback(LOOP_UART);
+	uart_enableRx(LOOP_UART);
+	/* drop anything received before */
+	while (0 != uart_read(LOOP_UART, PHASE_ACCESS(bench_uart, rx), NR_BYTES)) {
+		/* an empty loop */
+	}
+
+	t = PHASE_ACCESS(bench_uart, tx);
+	r = PHASE_ACCESS(bench_uart, rx);
+	start = bench_now();
+	for (i = 0; i < NR_BYTES; i++) {
+		uart_printChar(LOOP_UART, t[i]);
+		n = uart_read(LOOP_UART, &r[i], 1);
+		while (0 == n) {
+			n = uart_read(LOOP_UART, &r[i], 1);
+		}
+	}
+	bench_report("uart loopback", start - bench_now(), NR_BYTES);
+
+	uart_disableRx(LOOP_UART);
+	uart_disableLoopback(LOOP_UART);
+
+	t = PHASE_ACCESS(bench_uart, tx);
+	r = PHASE_ACCESS(bench_uart, rx);
+	for (i = 0; i < NR_BYTES; i++) {
+		if (r[i] != t[i]) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,191 @@
+/**
+ * @file
+ *
+ * Commands of the UART shell (app/commands.cmd) and the shell_run export
+ * polling it.
+ */
+
+#include <stddef.h>
+
+#include "bench.h"
+#include "export.h"
+#include "histogram.h"
+#include "import.h"
+#include "memo.h"
+#include "phase.h"
+#include "ratelimit.h"
+#include "shell.h"
+
+#define PEEK_MAX (64)
+
+static struct shell console;
+static bool console_ready;
+
+/**
+ * Serves the shell on the benchmark UART: executes the commands received
+ * since the last call and returns, the host calls it from its idle loop or
+ * its UART receive interrupt.
+ *
+ * @return number of commands executed
+ */
+int shell_run(void)
+{
+	if (!console_ready) {
+		shell_init(&console, BENCH_UART);
+		console_ready = true;
+	}
+
+	return shell_poll(&console);
+}
+
+int cmd_help(int argc, char **argv)
+{
+	const char *name, *help;
+	u32 slot;
+
+	for (slot = 0; slot < shell_nr_slots(); slot++) {
+		name = shell_name(slot, &help);
+		if (NULL == name) {
+			continue;
+		}
+		shell_print(name);
+		shell_print("\t");
+		shell_print(help);
+		shell_print("\n");
+	}
+
+	return 0;
+}
+
+int cmd_echo(int argc, char **argv)
+{
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		shell_print(argv[i]);
+		shell_print(i + 1 < argc ? " " : "");
+	}
+	shell_print("\n");
+
+	return 0;
+}
+
+int cmd_peek(int argc, char **argv)
+{
+	u32 addr, n = 1;
+	u32 i;
+
+	if (argc < 2 || !shell_parseU32(argv[1], &addr) || 0 != (addr & 3) ||
+		(argc > 2 && !shell_parseU32(argv[2], &n)) || n > PEEK_MAX) {
+		return -1;
+	}
+	for (i = 0; i < n; i++, addr += 4) {
+		if (0 == (i & 3)) {
+			shell_print(0 == i ? "" : "\n");
+			shell_printHex(addr);
+			shell_print(":");
+		}
+		shell_print(" ");
+		shell_printHex(*(volatile u32 *)addr);
+	}
+	shell_print("\n");
+
+	return 0;
+}
+
+int cmd_poke(int argc, char **argv)
+{
+	u32 addr, value;
+
+	if (argc != 3 || !shell_parseU32(argv[1], &addr) || 0 != (addr & 3) ||
+		!shell_parseU32(argv[2], &value)) {
+		return -1;
+	}
+	*(volatile u32 *)addr = value;
+
+	return 0;
+}
+
+int cmd_stats(int argc, char **argv)
+{
+	const struct pic_export *exp;
+
+	for (exp = __exports_start__; exp < __exports_end__; exp++) {
+		shell_print((const char *)(__pic_base + exp->name));
+		shell_print(": ");
+		shell_printDec(exp->calls);
+		shell_print(" calls, ");
+		shell_printDec((u32)exp->ticks);
+		shell_print(" ticks, max ");
+		shell_printDec(exp->ticks_max);
+		shell_print("\n");
+	}
+
+	return 0;
+}
+
+int cmd_hist(int argc, char **argv)
+{
+	const struct histogram *h;
+
+	for (h = __histograms_start__; h < __histograms_end__; h++) {
+		shell_print((const char *)(__pic_base + (u32)h->name));
+		shell_print(": ");
+		shell_printDec(h->count);
+		shell_print(", p50 ");
+		shell_printDec(histogram_percentile(h, 500));
+		shell_print(", p99 ");
+		shell_printDec(histogram_percentile(h, 990));
+		shell_print(", p99.9 ");
+		shell_printDec(histogram_percentile(h, 999));
+		shell_print(", max ");
+		shell_printDec(h->max);
+		shell_print("\n");
+	}
+
+	return 0;
+}
+
+int cmd_limits(int argc, char **argv)
+{
+	const struct ratelimit *rl;
+
+	for (rl = __ratelimits_start__; rl < __ratelimits_end__; rl++) {
+		shell_print((const char *)(__pic_base + (u32)rl->name));
+		shell_print(": ");
+		shell_printDec(rl->passed);
+		shell_print(" passed, ");
+		shell_printDec(rl->dropped);
+		shell_print(" dropped\n");
+	}
+
+	return 0;
+}
+
+int cmd_memo(int argc, char **argv)
+{
+	const struct memo *m;
+
+	for (m = __memos_start__; m < __memos_end__; m++) {
+		shell_print((const char *)(__pic_base + (u32)m->name));
+		shell_print(": ");
+		shell_printDec(m->hits);
+		shell_print(" hits, ");
+		shell_printDec(m->misses);
+		shell_print(" misses, ");
+		shell_printDec(m->evictions);
+		shell_print(" evictions\n");
+	}
+
+	return 0;
+}
+
+int cmd_phase(int argc, char **argv)
+{
+	shell_print(NULL != phase_active ? phase_active : "none");
+	shell_print(": ");
+	shell_printDec(phase_faults);
+	shell_print(" faults\n");
+
+	return 0;
+}
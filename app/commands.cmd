@@ -0,0 +1,10 @@
+# shell commands (see include/shell.h): <command> <handler> [# help]
+help     cmd_help   # list the commands
+echo     cmd_echo   # print the arguments
+peek     cmd_peek   # peek <addr> [words]: print words of memory
+poke     cmd_poke   # poke <addr> <value>: write a word of memory
+stats    cmd_stats  # calls and ticks of every export
+hist     cmd_hist   # count, p50, p99, p99.9 and max of every histogram
+limits   cmd_limits # messages passed and dropped by every rate limiter
+memo     cmd_memo   # hits, misses and evictions of every memo cache
+phase    cmd_phase  # active phase and accesses to inactive ones (PIC_PHASE_CHECK)
@@ -1,5 +1,42 @@
 #include "uart.h"
 
+#if defined(PIC_TUNE_BENCH)
+/*
+ * Autotuner build (scripts/autotune.py): run one benchmark, then stop QEMU
+ * with the semihosting SYS_EXIT_EXTENDED call, the exit status is the
+ * benchmark's return value.
+ */
+int PIC_TUNE_BENCH(void);
+
+int main(void)
+{
+	/* ADP_Stopped_ApplicationExit, status */
+	u32 block[2] = {0x20026, 0};
+
+	block[1] = (u32)PIC_TUNE_BENCH();
+	__asm__ volatile("mov r0, #0x20\n"
+					 "mov r1, %0\n"
+					 "svc 0x123456\n"
+					 :
+					 : "r"(block)
+					 : "r0", "r1", "memory");
+	return 0;
+}
+#elif defined(PIC_RPC_SERVE)
+/*
+ * Serves the remote calls (app/rpcs.rpc) for scripts/rpcclient.py, which
+ * talks to UART 2 through a QEMU pipe.
+ */
+int rpc_run(void);
+
+int main(void)
+{
+	while (1) {
+		rpc_run();
+	}
+	return 0;
+}
+#else
 int main(void)
 {
 	// foo();
@@ -9,4 +46,5 @@ int main(void)
 			uart_printChar(0, hello[i]);
 	}
 	return 0;
-}
\ No newline at end of file
+}
+#endif
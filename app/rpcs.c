@@ -0,0 +1,61 @@
+/**
+ * @file
+ *
+ * Remote calls served on RPC_UART (app/rpcs.rpc) and the rpc_run export
+ * polling them.
+ */
+
+#include <stdbool.h>
+
+#include "bench.h"
+#include "rpc.h"
+#include "uart.h"
+
+/* UART 1 is the benchmark loopback (bench_uart) */
+#define RPC_UART (2)
+
+static struct rpc server;
+static bool server_ready;
+
+/**
+ * Serves the remote calls: executes the requests received since the last
+ * call and returns, the host calls it from its idle loop or its UART
+ * receive interrupt.
+ *
+ * @return number of calls completed
+ */
+int rpc_run(void)
+{
+	if (!server_ready) {
+		uart_init(RPC_UART);
+		rpc_init(&server, RPC_UART);
+		server_ready = true;
+	}
+
+	return rpc_poll(&server);
+}
+
+int rpc_echo(u32 value) { return (int)value; }
+
+/**
+ * Poll function: the first call of a request records the start in its
+ * state, the next ones return RPC_BUSY until 'us' microseconds have passed.
+ * Each request sleeps on its own start.
+ *
+ * @param us - microseconds to sleep
+ * @param state - start in export timer ticks, kept with the request
+ *
+ * @return 0 once the time has passed
+ */
+int rpc_sleep(u32 us, u32 *state)
+{
+	u32 now = bench_now();
+
+	/* 0 marks the first call, a start of 0 is taken one tick later */
+	if (0 == *state) {
+		*state = (0 != now ? now : (u32)-1);
+	}
+
+	/* the export timer counts down at 1 MHz */
+	return (*state - now < us ? RPC_BUSY : 0);
+}
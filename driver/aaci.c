@@ -0,0 +1,376 @@
+/**
+ * @file
+ *
+ * Implementation of the audio output through the AACI (PL041), see aaci.h.
+ * Only channel 1 is used, transmitting 16-bit samples in compact mode: one
+ * FIFO entry carries both samples of a frame (AC'97 slots 3 and 4).
+ *
+ * More info about the board and the AACI controller:
+ * - Versatile Application Baseboard for ARM926EJ-S, HBI 0118 (DUI0225D):
+ *   http://infocenter.arm.com/help/topic/com.arm.doc.dui0225d/DUI0225D_versatile_application_baseboard_arm926ej_s_ug.pdf
+ * - PrimeCell Advanced Audio CODEC Interface (PL041) Technical Reference
+ *   Manual (DDI0173):
+ *   http://infocenter.arm.com/help/topic/com.arm.doc.ddi0173b/DDI0173.pdf
+ * - National Semiconductor LM4549 AC'97 codec data sheet
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bsp.h"
+#include "aaci.h"
+#include "clock.h"
+#include "irq.h"
+#include "regutil.h"
+
+/* Number of FIFO channels of the controller */
+#define AACI_NR_CHANNELS (4)
+
+/*
+ * Bit masks for the channel's Transmit Control Register (AACITXCRx), see
+ * DDI0173:
+ *
+ *     0: TxEn: 0 disabled; 1 enabled
+ *  1-12: TxnSL: transmit data in slot n
+ * 13-14: TSIZE: 00 16 bits; 01 18 bits; 10 20 bits; 11 12 bits
+ *    15: TxCompact: two 16-bit samples per FIFO entry
+ *    16: TxFEn: FIFO enabled
+ */
+#define TXCR_EN		 (0x00000001)
+#define TXCR_SL3	 (0x00000008)
+#define TXCR_SL4	 (0x00000010)
+#define TXCR_SZ16	 (0x00000000)
+#define TXCR_COMPACT (0x00008000)
+#define TXCR_FEN	 (0x00010000)
+
+/*
+ * Bit masks for the channel's Status Register (AACISRx):
+ *
+ *  0: RXFE  1: TXFE (transmit FIFO empty)
+ *  2: RXHF  3: TXHE (transmit FIFO half empty or less)
+ *  4: RXFF  5: TXFF (transmit FIFO full)
+ *  6: RXBUSY  7: TXBUSY
+ *  8: RXOVERRUN  9: TXUNDERRUN (latched until cleared by AACIINTCLR)
+ */
+#define SR_TXFE (0x00000002)
+#define SR_TXHE (0x00000008)
+#define SR_TXFF (0x00000020)
+#define SR_TXU	(0x00000200)
+
+/*
+ * Bit masks for the channel's Interrupt Enable Register (AACIIEx):
+ *
+ *  0: TxCIE (transmit complete)  1: RxTOIE (receive timeout)
+ *  2: TxIE (transmit FIFO half empty)  3: RxIE (receive FIFO half full)
+ *  4: RxOIE (receive overrun)  5: TxUIE (transmit underrun)
+ *  6: RxTOFEIE
+ */
+#define IE_TXIE (0x00000004)
+
+/* Bit masks for the Slot Flag Register (AACISLFR), slot 1 and 2 busy */
+#define SLFR_1TXB (0x00000002)
+#define SLFR_2TXB (0x00000008)
+
+/*
+ * Bit masks for the Interrupt Clear Register (AACIINTCLR):
+ *
+ *  0: WISC (wake up)  1: RxOEC1 (channel 1 receive overrun)
+ *  2: TxUEC1 (channel 1 transmit underrun)
+ *  3: RxOEC2  4: TxUEC2  5: RxOEC3  6: TxUEC3  7: RxOEC4  8: TxUEC4
+ */
+#define INTCLR_TXUEC1 (0x00000004)
+
+/*
+ * Bit masks for the Main Control Register (AACIMAINCR):
+ *
+ *    0: AACIfEn: interface enabled
+ *    1: LoopBack  2: LowPowerMode
+ *  3-8: slot 1, 2, 12 receive/transmit enable (SL1RxEn first)
+ *    9: DMAEnable
+ */
+#define MAINCR_IE	   (0x00000001)
+#define MAINCR_SL1RXEN (0x00000008)
+#define MAINCR_SL1TXEN (0x00000010)
+#define MAINCR_SL2RXEN (0x00000020)
+#define MAINCR_SL2TXEN (0x00000040)
+
+/* Bit mask for the Reset Register (AACIRESET): codec out of reset */
+#define RESET_NRST (0x00000001)
+
+/* Free FIFO entries when SR_TXHE is set, for the default depth of 8 */
+#define FIFO_HALF (4)
+
+/* Polls of the slot flags before a codec register write is given up */
+#define CODEC_TIMEOUT (10000)
+
+/* LM4549 registers, see its data sheet */
+#define LM4549_MASTER_VOLUME  (0x02)
+#define LM4549_PCM_OUT_VOLUME (0x18)
+
+/* 0 dB, unmuted */
+#define LM4549_MASTER_0DB (0x0000)
+#define LM4549_PCM_0DB	  (0x0808)
+
+/*
+ * 32-bit registers of a FIFO channel, relative to the channel's base
+ * address (0x14 bytes apart).
+ */
+typedef struct _PL041_CHANNEL_REGS {
+	u32 RXCR;	   /* Receive Control Register, AACIRXCRx */
+	u32 TXCR;	   /* Transmit Control Register, AACITXCRx */
+	const u32 SR;  /* Status Register, AACISRx, read only */
+	const u32 ISR; /* Interrupt Status Register, AACIISRx, read only */
+	u32 IE;		   /* Interrupt Enable Register, AACIIEx */
+} PL041_CHANNEL_REGS;
+
+/*
+ * 32-bit registers of the controller, the identification registers are not
+ * used by this driver. See DDI0173.
+ */
+typedef struct _PL041_REGS {
+	PL041_CHANNEL_REGS CH[AACI_NR_CHANNELS]; /* 0x00 */
+	u32 SL1RX;								 /* slot 1 (register address) */
+	u32 SL1TX;
+	u32 SL2RX; /* slot 2 (register data) */
+	u32 SL2TX;
+	u32 SL12RX;
+	u32 SL12TX;
+	const u32 SLFR;	   /* Slot Flag Register, read only */
+	const u32 SLISTAT; /* Slot Interrupt Status Register, read only */
+	u32 SLIEN;		   /* Slot Interrupt Enable Register */
+	u32 INTCLR;		   /* Interrupt Clear Register, write only */
+	u32 MAINCR;		   /* Main Control Register */
+	u32 RESET;		   /* Reset Control Register */
+	const u32 SYNC;	   /* Sync Control Register */
+	const u32 ALLINTS; /* All FIFO Interrupts Status Register */
+	const u32 MAINFR;  /* Main Flag Register */
+	const u32 Reserved;
+	u32 DR[AACI_NR_CHANNELS][8]; /* FIFO data, 0x90, any of the 8 words */
+} PL041_REGS;
+
+static volatile PL041_REGS *const pReg = (PL041_REGS *)(BSP_AACI_BASE_ADDRESS);
+
+/*
+ * Ring of frames, aaci_write() is its only producer and aaci_poll() (with
+ * IRQs masked) its only consumer.
+ */
+static u32 aaci_ring[AACI_RING_FRAMES];
+static volatile u32 aaci_head;
+static volatile u32 aaci_tail;
+
+static struct aaci_stats aaci_stats;
+
+/* FIFO half empty interrupt in use */
+static bool aaci_irq;
+
+/* frames have been written since aaci_init() or aaci_drain() */
+static bool aaci_streaming;
+
+/* busy waits for 'us' microseconds */
+static void aaci_delay(u32 us)
+{
+	u32 start = clock_read();
+
+	while (clock_read() - start < clock_fromUs(us)) {
+		/* an empty loop */
+	}
+}
+
+/* writes 'value' to the codec register 'reg' through slots 1 and 2 */
+static void aaci_writeCodec(u32 reg, u32 value)
+{
+	u32 i;
+
+	pReg->SL2TX = value << 4;
+	pReg->SL1TX = reg << 12;
+	for (i = 0; i < CODEC_TIMEOUT; i++) {
+		if (0 == HWREG_READ_BITS(pReg->SLFR, SLFR_1TXB | SLFR_2TXB)) {
+			break;
+		}
+	}
+}
+
+/**
+ * Resets the codec, unmutes its outputs and enables channel 1 to transmit
+ * 16-bit stereo frames in compact mode. The ring is emptied, the FIFO half
+ * empty interrupt is disabled.
+ */
+void aaci_init(void)
+{
+	/* The interface and the channel are disabled before reconfiguration: */
+	pReg->CH[0].IE = 0;
+	pReg->CH[0].TXCR = 0;
+	pReg->MAINCR = 0;
+
+	/* Hold the codec in reset for at least 1 us: */
+	pReg->RESET = 0;
+	aaci_delay(2);
+	pReg->RESET = RESET_NRST;
+
+	pReg->MAINCR = MAINCR_IE | MAINCR_SL1RXEN | MAINCR_SL1TXEN |
+				   MAINCR_SL2RXEN | MAINCR_SL2TXEN;
+
+	aaci_writeCodec(LM4549_MASTER_VOLUME, LM4549_MASTER_0DB);
+	aaci_writeCodec(LM4549_PCM_OUT_VOLUME, LM4549_PCM_0DB);
+
+	pReg->CH[0].TXCR =
+		TXCR_FEN | TXCR_COMPACT | TXCR_SZ16 | TXCR_SL3 | TXCR_SL4 | TXCR_EN;
+	pReg->INTCLR = INTCLR_TXUEC1;
+
+	aaci_head = 0;
+	aaci_tail = 0;
+	aaci_irq = false;
+	aaci_streaming = false;
+	aaci_stats.frames = 0;
+	aaci_stats.underruns = 0;
+	aaci_stats.irqs = 0;
+}
+
+/**
+ * Copies as many of the frames as fit into the ring, they are played after
+ * the frames written before.
+ *
+ * @param frames - frames packed by AACI_FRAME()
+ * @param n - number of frames
+ *
+ * @return number of frames copied, less than 'n' if the ring is full
+ */
+u32 aaci_write(const u32 *frames, u32 n)
+{
+	u32 head = aaci_head;
+	u32 room = AACI_RING_FRAMES - (head - aaci_tail);
+	u32 cpsr;
+	u32 i;
+
+	n = (n < room ? n : room);
+	for (i = 0; i < n; i++) {
+		aaci_ring[(head + i) & (AACI_RING_FRAMES - 1)] = frames[i];
+	}
+	/* the frames must be in the ring before the consumer can see them */
+	__asm__ volatile("" ::: "memory");
+	aaci_head = head + n;
+
+	if (aaci_irq && 0 != n) {
+		cpsr = irq_save();
+		HWREG_SET_BITS(pReg->CH[0].IE, IE_TXIE);
+		irq_restore(cpsr);
+	}
+
+	return n;
+}
+
+/**
+ * @return number of frames aaci_write() can copy into the ring
+ */
+u32 aaci_room(void) { return AACI_RING_FRAMES - (aaci_head - aaci_tail); }
+
+/**
+ * Moves frames from the ring into the FIFO, FIFO_HALF at a time while it is
+ * at least half empty, so the status register is read once per burst rather
+ * than once per frame. Counts a latched underrun if it happened while
+ * streaming. IRQs are masked, so the thread may call it while the interrupt
+ * is in use.
+ *
+ * @return number of frames moved
+ */
+u32 aaci_poll(void)
+{
+	u32 cpsr = irq_save();
+	u32 tail = aaci_tail;
+	u32 head = aaci_head;
+	u32 moved = 0;
+	u32 sr = pReg->CH[0].SR;
+	u32 k;
+
+	if (0 != (sr & SR_TXU)) {
+		pReg->INTCLR = INTCLR_TXUEC1;
+		if (aaci_streaming) {
+			aaci_stats.underruns++;
+		}
+	}
+
+	while (tail != head && 0 != (sr & SR_TXHE)) {
+		for (k = 0; k < FIFO_HALF && tail != head; k++, tail++) {
+			pReg->DR[0][0] = aaci_ring[tail & (AACI_RING_FRAMES - 1)];
+		}
+		moved += k;
+		sr = pReg->CH[0].SR;
+	}
+
+	aaci_tail = tail;
+	aaci_stats.frames += moved;
+	aaci_streaming = aaci_streaming || 0 != moved;
+	irq_restore(cpsr);
+
+	return moved;
+}
+
+/**
+ * Waits until every frame has been played, the next frames written start a
+ * new stream: the FIFO running empty before them is not an underrun.
+ */
+void aaci_drain(void)
+{
+	while (aaci_head != aaci_tail) {
+		aaci_poll();
+	}
+	while (0 == HWREG_READ_BITS(pReg->CH[0].SR, SR_TXFE)) {
+		/* an empty loop */
+	}
+
+	aaci_streaming = false;
+	pReg->INTCLR = INTCLR_TXUEC1;
+}
+
+/**
+ * Handler of the AACI interrupt (SIC IRQ BSP_AACI_SIC_IRQ). Refills the
+ * FIFO, and disables the half empty interrupt, which stays asserted, once
+ * the ring is empty. aaci_write() enables it again.
+ */
+void aaci_isr(void)
+{
+	aaci_stats.irqs++;
+	aaci_poll();
+
+	if (aaci_head == aaci_tail) {
+		HWREG_CLEAR_BITS(pReg->CH[0].IE, IE_TXIE);
+	}
+}
+
+/**
+ * Enables the FIFO half empty interrupt, the host must route the AACI IRQ
+ * to aaci_isr().
+ */
+void aaci_enableTxInterrupt(void)
+{
+	u32 cpsr = irq_save();
+
+	aaci_irq = true;
+	if (aaci_head != aaci_tail) {
+		HWREG_SET_BITS(pReg->CH[0].IE, IE_TXIE);
+	}
+	irq_restore(cpsr);
+}
+
+/**
+ * Disables the FIFO half empty interrupt, the thread must call aaci_poll().
+ */
+void aaci_disableTxInterrupt(void)
+{
+	u32 cpsr = irq_save();
+
+	aaci_irq = false;
+	HWREG_CLEAR_BITS(pReg->CH[0].IE, IE_TXIE);
+	irq_restore(cpsr);
+}
+
+/**
+ * @param stats - receives a copy of the counters
+ */
+void aaci_getStats(struct aaci_stats *stats)
+{
+	u32 cpsr = irq_save();
+
+	*stats = aaci_stats;
+	irq_restore(cpsr);
+}
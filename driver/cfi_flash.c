@@ -0,0 +1,287 @@
+/**
+ * @file
+ *
+ * Implementation of the CFI NOR flash driver, see cfi_flash.h.
+ *
+ * The bank is 32 bits wide. With two interleaved x16 devices every command
+ * is written to both halves of the bus and both must report ready, a single
+ * device (QEMU's flash without a device width) answers in the lower half.
+ * Offsets of the query table are in bus words.
+ *
+ * More info about the command set and the query table:
+ * - Common Flash Interface (CFI) and Command Sets, JEDEC JESD68
+ * - Intel StrataFlash Memory (J3) data sheet
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "cfi_flash.h"
+
+/* Commands of the Intel/Sharp extended command set */
+#define CMD_READ_ARRAY	 (0xFF)
+#define CMD_READ_STATUS	 (0x70)
+#define CMD_CLEAR_STATUS (0x50)
+#define CMD_QUERY		 (0x98)
+#define CMD_ERASE		 (0x20)
+#define CMD_WRITE_BUFFER (0xE8)
+#define CMD_CONFIRM		 (0xD0)
+
+/*
+ * Bit masks for the Status Register of a device:
+ *
+ * 1: block locked  3: VPP low  4: program error  5: erase error
+ * 7: write state machine ready
+ */
+#define SR_LOCKED  (0x02)
+#define SR_VPP	   (0x08)
+#define SR_PROGRAM (0x10)
+#define SR_ERASE   (0x20)
+#define SR_READY   (0x80)
+
+/* Word offsets of the query table */
+#define QRY_ADDRESS		(0x55) /* where CMD_QUERY is written */
+#define QRY_SIGNATURE	(0x10) /* "QRY" */
+#define QRY_COMMAND_SET (0x13) /* primary command set, 16 bits */
+#define QRY_SIZE		(0x27) /* log2 of the device size */
+#define QRY_BUFFER		(0x2A) /* log2 of the write buffer, 16 bits */
+#define QRY_REGIONS		(0x2C) /* number of erase block regions */
+#define QRY_REGION0		(0x2D) /* blocks - 1 (16 bits), size / 256 (16 bits) */
+
+/* Primary command sets served by this driver */
+#define CFI_INTEL_EXTENDED (0x0001)
+#define CFI_INTEL_STANDARD (0x0003)
+
+/* Operations in progress */
+#define OP_NONE	   (0)
+#define OP_ERASE   (1)
+#define OP_PROGRAM (2)
+
+/* Status reads before a write buffer is given up as unavailable */
+#define BUFFER_TIMEOUT (10000)
+
+/* byte 'i' of the query table, from the first device */
+static u32 cfi_query(const struct cfi_flash *f, u32 i) { return f->base[i] & 0xFF; }
+
+/* 16-bit little endian entry of the query table at 'i' */
+static u32 cfi_query16(const struct cfi_flash *f, u32 i)
+{
+	return cfi_query(f, i) | cfi_query(f, i + 1) << 8;
+}
+
+/* writes the command 'cmd' to every device at the word 'offset' */
+static void cfi_command(struct cfi_flash *f, u32 offset, u32 cmd)
+{
+	f->base[offset / 4] = cmd * f->rep;
+}
+
+/* true if the status 'sr' read from the bus has every device ready */
+static bool cfi_ready(const struct cfi_flash *f, u32 sr)
+{
+	return (sr & SR_READY * f->rep) == SR_READY * f->rep;
+}
+
+/**
+ * Identifies the flash by its CFI query table and leaves it in read array
+ * mode. Only the first erase block region is used, the sectors are
+ * expected to be uniform.
+ *
+ * @param f - flash to initialize
+ * @param base - address of the mapped array
+ *
+ * @return 0, or CFI_ENODEV if no supported flash answers at 'base'
+ */
+int cfi_flash_probe(struct cfi_flash *f, u32 base)
+{
+	u32 chips, buffer, sector;
+
+	f->base = (volatile u32 *)base;
+	f->rep = 0x00010001;
+	f->op = OP_NONE;
+	f->errors = 0;
+
+	cfi_command(f, 0, CMD_READ_ARRAY);
+	cfi_command(f, QRY_ADDRESS * 4, CMD_QUERY);
+	if ('Q' != cfi_query(f, QRY_SIGNATURE) ||
+		'R' != cfi_query(f, QRY_SIGNATURE + 1) ||
+		'Y' != cfi_query(f, QRY_SIGNATURE + 2)) {
+		cfi_command(f, 0, CMD_READ_ARRAY);
+		return CFI_ENODEV;
+	}
+
+	/* interleaved devices both answer the query */
+	chips = ('Q' == (f->base[QRY_SIGNATURE] >> 16 & 0xFF) ? 2 : 1);
+	if (1 == chips) {
+		f->rep = 1;
+	}
+
+	switch (cfi_query16(f, QRY_COMMAND_SET)) {
+	case CFI_INTEL_EXTENDED:
+	case CFI_INTEL_STANDARD:
+		break;
+	default:
+		cfi_command(f, 0, CMD_READ_ARRAY);
+		return CFI_ENODEV;
+	}
+
+	buffer = 1 << cfi_query16(f, QRY_BUFFER);
+	sector = cfi_query16(f, QRY_REGION0 + 2) * 256;
+	f->size = (1 << cfi_query(f, QRY_SIZE)) * chips;
+	f->sector_size = (0 != sector ? sector : 128) * chips;
+	f->buffer_size = (buffer < CFI_BUFFER_MAX ? buffer : CFI_BUFFER_MAX) * chips;
+
+	cfi_command(f, 0, CMD_READ_ARRAY);
+
+	return 0;
+}
+
+/**
+ * Starts erasing the sector containing 'offset', cfi_flash_poll() reports
+ * its completion.
+ *
+ * @param f - flash
+ * @param offset - byte offset of the sector, or of any byte in it
+ *
+ * @return 0, CFI_BUSY if another operation is in progress, or CFI_EINVAL
+ */
+int cfi_flash_eraseStart(struct cfi_flash *f, u32 offset)
+{
+	if (OP_NONE != f->op) {
+		return CFI_BUSY;
+	}
+	if (offset >= f->size) {
+		return CFI_EINVAL;
+	}
+
+	offset &= ~(f->sector_size - 1);
+	cfi_command(f, offset, CMD_CLEAR_STATUS);
+	cfi_command(f, offset, CMD_ERASE);
+	cfi_command(f, offset, CMD_CONFIRM);
+	f->op = OP_ERASE;
+
+	return 0;
+}
+
+/**
+ * Loads the write buffer with the first bytes of 'data' and starts
+ * programming them, cfi_flash_poll() reports its completion. At most
+ * buffer_size bytes are taken, and none beyond the end of the write buffer
+ * 'offset' lies in. 'data' may be released on return.
+ *
+ * @param f - flash
+ * @param offset - byte offset in the flash, 4 byte aligned
+ * @param data - bytes to program, any alignment
+ * @param len - number of bytes, whole words are programmed
+ *
+ * @return number of bytes taken, CFI_BUSY if another operation is in
+ * progress or the write buffer is not available, or CFI_EINVAL
+ */
+int cfi_flash_programStart(struct cfi_flash *f, u32 offset, const void *data,
+						   u32 len)
+{
+	const u8 *p = data;
+	u32 room = f->buffer_size - (offset & (f->buffer_size - 1));
+	u32 words, i;
+
+	if (OP_NONE != f->op) {
+		return CFI_BUSY;
+	}
+	if (0 != (offset & 3) || offset >= f->size || len < 4) {
+		return CFI_EINVAL;
+	}
+	len = (len < room ? len : room) & ~3;
+	len = (len < f->size - offset ? len : f->size - offset);
+	words = len / 4;
+
+	cfi_command(f, offset, CMD_CLEAR_STATUS);
+	cfi_command(f, offset, CMD_WRITE_BUFFER);
+	for (i = 0; i < BUFFER_TIMEOUT; i++) {
+		if (cfi_ready(f, f->base[offset / 4])) {
+			break;
+		}
+	}
+	if (BUFFER_TIMEOUT == i) {
+		cfi_command(f, offset, CMD_READ_ARRAY);
+		return CFI_BUSY;
+	}
+
+	/* words per device - 1, then the data */
+	cfi_command(f, offset, words - 1);
+	for (i = 0; i < words; i++, p += 4) {
+		f->base[offset / 4 + i] = p[0] | p[1] << 8 | p[2] << 16 | (u32)p[3] << 24;
+	}
+	cfi_command(f, offset, CMD_CONFIRM);
+	f->op = OP_PROGRAM;
+
+	return len;
+}
+
+/**
+ * Completes the operation in progress if the devices are ready, and
+ * returns the flash to read array mode.
+ *
+ * @param f - flash
+ *
+ * @return 0 if no operation is in progress any more, CFI_BUSY if it is, or
+ * the error of the operation just completed
+ */
+int cfi_flash_poll(struct cfi_flash *f)
+{
+	u32 sr;
+	int ret = 0;
+
+	if (OP_NONE == f->op) {
+		return 0;
+	}
+
+	sr = f->base[0];
+	if (!cfi_ready(f, sr)) {
+		return CFI_BUSY;
+	}
+
+	sr |= sr >> 16;
+	if (0 != (sr & SR_LOCKED)) {
+		ret = CFI_ELOCKED;
+	} else if (0 != (sr & (SR_ERASE | SR_PROGRAM | SR_VPP))) {
+		ret = (OP_ERASE == f->op ? CFI_EERASE : CFI_EPROGRAM);
+	}
+	if (0 != ret) {
+		f->errors++;
+		cfi_command(f, 0, CMD_CLEAR_STATUS);
+	}
+	cfi_command(f, 0, CMD_READ_ARRAY);
+	f->op = OP_NONE;
+
+	return ret;
+}
+
+/**
+ * Copies bytes of the array, which cannot be read while an operation is in
+ * progress.
+ *
+ * @param f - flash
+ * @param offset - byte offset in the flash
+ * @param buf - destination
+ * @param len - number of bytes
+ *
+ * @return 0, CFI_BUSY or CFI_EINVAL
+ */
+int cfi_flash_read(struct cfi_flash *f, u32 offset, void *buf, u32 len)
+{
+	const volatile u8 *src = (const volatile u8 *)f->base + offset;
+	u8 *dst = buf;
+	u32 i;
+
+	if (OP_NONE != f->op) {
+		return CFI_BUSY;
+	}
+	if (offset > f->size || len > f->size - offset) {
+		return CFI_EINVAL;
+	}
+
+	for (i = 0; i < len; i++) {
+		dst[i] = src[i];
+	}
+
+	return 0;
+}
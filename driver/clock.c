@@ -0,0 +1,40 @@
+/**
+ * @file
+ *
+ * 64-bit extension of the SYS_24MHZ counter, see clock.h.
+ *
+ * More info about the system registers:
+ * - Versatile Application Baseboard for ARM926EJ-S, HBI 0118 (DUI0225D),
+ *   section 4.3:
+ *   http://infocenter.arm.com/help/topic/com.arm.doc.dui0225d/DUI0225D_versatile_application_baseboard_arm926ej_s_ug.pdf
+ */
+
+#include "clock.h"
+#include "irq.h"
+
+/* upper 32 bits, and the counter at the last call */
+static u32 clock_high;
+static u32 clock_last;
+
+/**
+ * Must be called at least once per wrap of the counter (179 s). IRQs are
+ * masked while the extension is updated, so it may be called from the
+ * thread and interrupt contexts.
+ *
+ * @return ticks of the counter since it started, 64 bits
+ */
+u64 clock_now(void)
+{
+	u32 cpsr = irq_save();
+	u32 now = clock_read();
+	u64 ticks;
+
+	if (now < clock_last) {
+		clock_high++;
+	}
+	clock_last = now;
+	ticks = (u64)clock_high << 32 | now;
+	irq_restore(cpsr);
+
+	return ticks;
+}
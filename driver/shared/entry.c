@@ -0,0 +1,22 @@
+/**
+ * @file
+ *
+ * Entry of the shared driver blob (PIC_SHARED_DRIVER).
+ *
+ * Calling the blob at its load address initializes it (relocation, .bss)
+ * and returns its export table, which pic_import_resolve() of a payload
+ * uses to fill in its imports.
+ */
+
+#include "export.h"
+#include "import.h"
+
+static struct pic_export_table table;
+
+int main(void)
+{
+	table.start = __exports_start__;
+	table.end = __exports_end__;
+
+	return (int)&table;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file
+ *
+ * Implementation of the board's SP804 timer functionality.
+ * Both dual timer controllers (4 counters) are supported.
+ *
+ * Counters are used as free-running 32-bit down counters, clocked by the
+ * 1 MHz TIMCLK reference, e.g. to time-stamp entries into the blob.
+ *
+ * More info about the board and the timer controller:
+ * - Versatile Application Baseboard for ARM926EJ-S, HBI 0118 (DUI0225D):
+ *   http://infocenter.arm.com/help/topic/com.arm.doc.dui0225d/DUI0225D_versatile_application_baseboard_arm926ej_s_ug.pdf
+ * - ARM Dual-Timer Module (SP804) Technical Reference Manual (DDI0271):
+ *   http://infocenter.arm.com/help/topic/com.arm.doc.ddi0271d/DDI0271.pdf
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bsp.h"
+#include "timer.h"
+#include "regutil.h"
+
+/*
+ * Bit masks for the Control Register (TimerXControl).
+ *
+ * For a detailed description of each control register's bit, see page 3-5 of
+ * DDI0271:
+ *
+ *   0: OneShot: 0 wrapping mode; 1 one-shot mode
+ *   1: TimerSize: 0 16-bit counter; 1 32-bit counter
+ * 2-3: TimerPre: prescale 00: /1, 01: /16, 10: /256
+ *   4: reserved (do not modify)
+ *   5: IntEnable: 0 disabled; 1 enabled
+ *   6: TimerMode: 0 free-running; 1 periodic
+ *   7: TimerEn: 0 disabled; 1 enabled
+ * 8-31: reserved (do not modify)
+ */
+#define CTL_ONESHOT	  (0x00000001)
+#define CTL_SIZE32	  (0x00000002)
+#define CTL_PRESCALE  (0x0000000C)
+#define CTL_INTEN	  (0x00000020)
+#define CTL_PERIODIC  (0x00000040)
+#define CTL_ENABLE	  (0x00000080)
+
+/*
+ * 32-bit registers of a single counter, relative to the counter's base
+ * address. See page 3-2 of DDI0271.
+ */
+typedef struct _SP804_COUNTER_REGS {
+	u32 LOAD;		 /* Load Register, TimerXLoad */
+	const u32 VALUE; /* Current Value Register, TimerXValue, read only */
+	u32 CONTROL;	 /* Control Register, TimerXControl */
+	u32 INTCLR;		 /* Interrupt Clear Register, TimerXIntClr, write only */
+	const u32 RIS;	 /* Raw Interrupt Status Register, TimerXRIS, read only */
+	const u32 MIS; /* Masked Interrupt Status Register, TimerXMIS, read only */
+	u32 BGLOAD;	   /* Background Load Register, TimerXBGLoad */
+	const u32 Reserved; /* reserved, should not be modified */
+} SP804_COUNTER_REGS;
+
+/*
+ * Both counters of a controller, followed by the test and identification
+ * registers that are not used by this driver.
+ */
+typedef struct _SP804_REGS {
+	SP804_COUNTER_REGS CTR[TIMER_NR_COUNTERS];
+} SP804_REGS;
+
+#define CAST_ADDR(ADDR) (SP804_REGS *)(ADDR),
+
+static volatile SP804_REGS *const pReg[BSP_NR_TIMERS] = {
+	BSP_TIMER_BASE_ADDRESSES(CAST_ADDR)};
+
+#undef CAST_ADDR
+
+/**
+ * Initializes a counter as a free-running 32-bit down counter with no
+ * prescaling. Its interrupt is disabled (masked out) and the counter is
+ * stopped, it must be started by timer_start().
+ *
+ * Nothing is done if 'nr' or 'ctr' is invalid.
+ *
+ * @param nr - number of the timer controller (between 0 and 1)
+ * @param ctr - number of the counter within the controller (between 0 and 1)
+ */
+void timer_init(u8 nr, u8 ctr)
+{
+	/* Sanity check */
+	if (nr >= BSP_NR_TIMERS || ctr >= TIMER_NR_COUNTERS) {
+		return;
+	}
+
+	/* The counter should be disabled before it is reconfigured: */
+	HWREG_CLEAR_BITS(pReg[nr]->CTR[ctr].CONTROL, CTL_ENABLE);
+
+	/* Wrapping, free-running 32-bit mode, prescaler 1, IRQ masked out: */
+	HWREG_CLEAR_BITS(pReg[nr]->CTR[ctr].CONTROL,
+					 (CTL_ONESHOT | CTL_PRESCALE | CTL_INTEN | CTL_PERIODIC));
+	HWREG_SET_BITS(pReg[nr]->CTR[ctr].CONTROL, CTL_SIZE32);
+
+	/* Count down from the largest value: */
+	pReg[nr]->CTR[ctr].LOAD = 0xFFFFFFFF;
+
+	/* reserved bits remained unmodified */
+}
+
+/**
+ * Starts the specified counter.
+ *
+ * Nothing is done if 'nr' or 'ctr' is invalid.
+ *
+ * @param nr - number of the timer controller (between 0 and 1)
+ * @param ctr - number of the counter within the controller (between 0 and 1)
+ */
+void timer_start(u8 nr, u8 ctr)
+{
+	/* Sanity check */
+	if (nr >= BSP_NR_TIMERS || ctr >= TIMER_NR_COUNTERS) {
+		return;
+	}
+
+	HWREG_SET_BITS(pReg[nr]->CTR[ctr].CONTROL, CTL_ENABLE);
+}
+
+/**
+ * Stops the specified counter. Its value is preserved.
+ *
+ * Nothing is done if 'nr' or 'ctr' is invalid.
+ *
+ * @param nr - number of the timer controller (between 0 and 1)
+ * @param ctr - number of the counter within the controller (between 0 and 1)
+ */
+void timer_stop(u8 nr, u8 ctr)
+{
+	/* Sanity check */
+	if (nr >= BSP_NR_TIMERS || ctr >= TIMER_NR_COUNTERS) {
+		return;
+	}
+
+	HWREG_CLEAR_BITS(pReg[nr]->CTR[ctr].CONTROL, CTL_ENABLE);
+}
+
+/**
+ * Returns whether the specified counter is running.
+ *
+ * 'false' is returned if 'nr' or 'ctr' is invalid.
+ *
+ * @param nr - number of the timer controller (between 0 and 1)
+ * @param ctr - number of the counter within the controller (between 0 and 1)
+ *
+ * @return true if the counter is enabled
+ */
+bool timer_isEnabled(u8 nr, u8 ctr)
+{
+	/* Sanity check */
+	if (nr >= BSP_NR_TIMERS || ctr >= TIMER_NR_COUNTERS) {
+		return false;
+	}
+
+	return 0 != HWREG_READ_BITS(pReg[nr]->CTR[ctr].CONTROL, CTL_ENABLE);
+}
+
+/**
+ * Returns the current value of the specified counter. The counter counts
+ * down, so the number of elapsed ticks between two readings 'a' and 'b' is
+ * (a - b), which is also correct when the counter has wrapped once.
+ *
+ * A zero is returned if 'nr' or 'ctr' is invalid.
+ *
+ * @param nr - number of the timer controller (between 0 and 1)
+ * @param ctr - number of the counter within the controller (between 0 and 1)
+ *
+ * @return current value of the counter
+ */
+u32 timer_getValue(u8 nr, u8 ctr)
+{
+	/* Sanity check */
+	if (nr >= BSP_NR_TIMERS || ctr >= TIMER_NR_COUNTERS) {
+		return 0;
+	}
+
+	return pReg[nr]->CTR[ctr].VALUE;
+}
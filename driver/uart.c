@@ -41,7 +41,10 @@
 #include <stdbool.h>
 
 #include "bsp.h"
+#include "cache.h"
 #include "uart.h"
+#include "iovec.h"
+#include "scan.h"
 #include "regutil.h"
 
 /*
@@ -135,6 +138,13 @@
 #define FR_TXFE (0x00000080)
 #define FR_RI	(0x00000100)
 
+/*
+ * Bitmask of the Line Control Register's FEN bit, see page 3-12 of the
+ * DDI0183. 0: the FIFOs are disabled and become 1-byte holding registers,
+ * 1: the 16-byte transmit and receive FIFOs are enabled. Its reset value is 0.
+ */
+#define LCRH_FEN (0x00000010)
+
 /*
  * 32-bit Registers of individual UART controllers,
  * relative to the controller's base address:
@@ -178,6 +188,19 @@ typedef struct _ARM926EJS_UART_REGS {
 /* Shared UART register: */
 #define UARTECR			UARTRSR
 
+/* Depth of the Transmit FIFO when enabled (LCRH_FEN), see DDI0183 */
+#define UART_TX_FIFO (16)
+
+/*
+ * With PIC_MMU the registers are bufferable (mmu.h): stores to UARTDR are
+ * posted, and the write buffer has to be drained before UARTFR is read.
+ */
+#if defined(PIC_MMU)
+#define __drain() cache_drain_write_buffer()
+#else
+#define __drain()
+#endif
+
 #define CAST_ADDR(ADDR) (ARM926EJS_UART_REGS *)(ADDR),
 
 static volatile ARM926EJS_UART_REGS *const pReg[BSP_NR_UARTS] = {
@@ -275,6 +298,7 @@ static inline void __printCh(u8 nr, char ch)
 	 * transmitted and the TXFF is set to 0, indicating the Transmit FIFO can
 	 * accept additional characters.
 	 */
+	__drain();
 	while (0 != HWREG_READ_BITS(pReg[nr]->UARTFR, FR_TXFF)) {
 		/* an empty loop; prevents "-Werror=misleading-indentation" */
 	}
@@ -340,11 +364,73 @@ void uart_print(u8 nr, const char *str)
 	/* handle possible NULL value of str: */
 	cp = (NULL == str ? null_str : (char *)str);
 
+	/* find the zero terminator a word at a time, then send in bursts */
+	uart_write(nr, cp, scan_strlen(cp));
+}
+
+/**
+ * Outputs a buffer of 'len' bytes to the specified UART.
+ * Unlike uart_print(), '\0' bytes are transmitted as well.
+ *
+ * Nothing is done if 'nr' is invalid (equal or greater than 3) or 'buf' is
+ * NULL.
+ *
+ * @param nr - number of the UART (between 0 and 2)
+ * @param buf - bytes to be sent to the UART
+ * @param len - number of bytes to send
+ */
+void uart_write(u8 nr, const void *buf, u32 len)
+{
+	const char *cp = buf;
+	u32 burst, n;
+
+	/* Sanity check */
+	if (nr >= BSP_NR_UARTS || NULL == buf) {
+		return;
+	}
+
 	/*
-	 * Just print each character until a zero terminator is detected
+	 * uart_init() leaves FEN as it is, the host may have configured the UART.
+	 * With FEN clear the "FIFO" is a 1-byte holding register.
 	 */
-	for (; '\0' != *cp; ++cp) {
-		__printCh(nr, *cp);
+	burst = (0 != HWREG_READ_BITS(pReg[nr]->UARTLC_H, LCRH_FEN) ? UART_TX_FIFO
+																: 1);
+
+	while (len > 0) {
+		/*
+		 * An empty Transmit FIFO takes a whole burst without polling the Flag
+		 * Register between the characters, otherwise fall back to one
+		 * character at a time.
+		 */
+		__drain();
+		if (0 == HWREG_READ_BITS(pReg[nr]->UARTFR, FR_TXFE)) {
+			__printCh(nr, *cp++);
+			len--;
+			continue;
+		}
+
+		n = (len < burst ? len : burst);
+		len -= n;
+		for (; n > 0; --n, ++cp) {
+			*((char *)&(pReg[nr]->UARTDR)) = *cp;
+		}
+	}
+}
+
+/**
+ * Outputs 'cnt' buffers to the specified UART, in order, without first
+ * gathering them into one buffer.
+ *
+ * Nothing is done if 'nr' is invalid (equal or greater than 3).
+ *
+ * @param nr - number of the UART (between 0 and 2)
+ * @param iov - buffers to be sent to the UART
+ * @param cnt - number of elements of 'iov'
+ */
+void uart_writev(u8 nr, const struct iovec *iov, u32 cnt)
+{
+	for (; cnt > 0; --cnt, ++iov) {
+		uart_write(nr, iov->iov_base, iov->iov_len);
 	}
 }
 
@@ -466,6 +552,27 @@ void uart_enableRx(u8 nr) { __setCrBit(nr, true, CTL_RXE); }
  */
 void uart_disableRx(u8 nr) { __setCrBit(nr, false, CTL_RXE); }
 
+/**
+ * Enables specified UART's loopback: transmitted characters are received by
+ * the same UART.
+ * UART's general enable status (UARTEN) remains unmodified.
+ *
+ * Nothing is done if 'nr' is invalid (equal or greater than 3).
+ *
+ * @param nr - number of the UART (between 0 and 2)
+ */
+void uart_enableLoopback(u8 nr) { __setCrBit(nr, true, CTL_LBE); }
+
+/**
+ * Disables specified UART's loopback.
+ * UART's general enable status (UARTEN) remains unmodified.
+ *
+ * Nothing is done if 'nr' is invalid (equal or greater than 3).
+ *
+ * @param nr - number of the UART (between 0 and 2)
+ */
+void uart_disableLoopback(u8 nr) { __setCrBit(nr, false, CTL_LBE); }
+
 /**
  * Enables the interrupt triggering by the specified UART when a character is
  * received.
@@ -547,6 +654,7 @@ char uart_readChar(u8 nr)
 	}
 
 	/* Wait until the receiving FIFO is not empty */
+	__drain();
 	while (0 != HWREG_READ_BITS(pReg[nr]->UARTFR, FR_RXFE))
 		;
 
@@ -560,3 +668,34 @@ char uart_readChar(u8 nr)
 
 	return *((char *)&(pReg[nr]->UARTDR));
 }
+
+/**
+ * Reads the characters already received by the specified UART, without
+ * blocking. At most 'len' characters are read into 'buf'.
+ *
+ * A zero is returned immediately if 'nr' is invalid (equal or greater than 3).
+ *
+ * @param nr - number of the UART (between 0 and 2)
+ * @param buf - buffer the characters are stored into
+ * @param len - size of the buffer
+ *
+ * @return number of characters read, 0 if the receive FIFO is empty
+ */
+u32 uart_read(u8 nr, void *buf, u32 len)
+{
+	char *cp = buf;
+	u32 n = 0;
+
+	/* Sanity check */
+	if (nr >= BSP_NR_UARTS) {
+		return 0;
+	}
+
+	__drain();
+	while (n < len && 0 == HWREG_READ_BITS(pReg[nr]->UARTFR, FR_RXFE)) {
+		/* see uart_readChar() */
+		cp[n++] = *((char *)&(pReg[nr]->UARTDR));
+	}
+
+	return n;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file
+ *
+ * Audio output through the Advanced Audio CODEC Interface (PL041) and the
+ * LM4549 AC'97 codec of the baseboard.
+ *
+ * Samples are 16-bit stereo frames at AACI_RATE, packed by AACI_FRAME() the
+ * way the transmit FIFO takes them in compact mode. aaci_write() only copies
+ * frames into a ring of AACI_RING_FRAMES, aaci_poll() moves them from the
+ * ring into the FIFO whenever it is at least half empty. It is called by
+ * aaci_isr() on the FIFO half empty interrupt, or by the thread if the
+ * interrupt is not used.
+ */
+
+#ifndef _AACI_H_
+#define _AACI_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <types.h>
+
+/* Sample rate of the codec's DAC (its reset value) */
+#define AACI_RATE (48000)
+
+/* Frames of the ring between aaci_write() and the FIFO, a power of 2 */
+#define AACI_RING_FRAMES (1024)
+
+/* A stereo frame of signed 16-bit samples, as written to the FIFO */
+#define AACI_FRAME(left, right) ((u32)(u16)(left) | (u32)(u16)(right) << 16)
+
+struct aaci_stats {
+	u32 frames;	   /* frames written to the FIFO */
+	u32 underruns; /* FIFO underruns while streaming */
+	u32 irqs;	   /* invocations of aaci_isr() */
+};
+
+void aaci_init(void);
+
+u32 aaci_write(const u32 *frames, u32 n);
+
+u32 aaci_room(void);
+
+u32 aaci_poll(void);
+
+void aaci_drain(void);
+
+void aaci_isr(void);
+
+void aaci_enableTxInterrupt(void);
+
+void aaci_disableTxInterrupt(void);
+
+void aaci_getStats(struct aaci_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AACI_H_ */
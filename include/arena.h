@@ -0,0 +1,32 @@
+/**
+ * @file
+ *
+ * Bump allocator over a caller provided memory area. Allocations are
+ * released all at once by arena_reset().
+ */
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <types.h>
+
+struct arena {
+	u8 *base;
+	u32 size;
+	u32 used;
+};
+
+void arena_init(struct arena *arena, void *mem, u32 size);
+
+void *arena_alloc(struct arena *arena, u32 size, u32 align);
+
+void arena_reset(struct arena *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ARENA_H_ */
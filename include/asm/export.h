@@ -0,0 +1,76 @@
+#ifndef __ASM_EXPORT_H
+#define __ASM_EXPORT_H
+
+/* struct pic_export 各成员偏移，见 export.h */
+#define EXPORT_VENEER	 0
+#define EXPORT_FUNC		 4
+#define EXPORT_NAME		 8
+#define EXPORT_CALLS	 12
+#define EXPORT_TICKS	 16
+#define EXPORT_TICKS_MAX 24
+#define EXPORT_ERROR	 28
+#define EXPORT_SLICES	 32
+#define EXPORT_SIZE		 40
+
+/* 内部栈均被占用时导出函数的返回值，见startup.S */
+#define PIC_EBUSY (-16)
+/* 导出函数经pic_yield()挂起，须调用pic_resume_entry继续 */
+#define PIC_PENDING (-17)
+/* pic_resume_entry：没有挂起的计算 */
+#define PIC_ENORESUME (-18)
+
+#ifdef __ASSEMBLY__
+
+/*
+ * 导出函数的入口，宿主直接调用veneer
+ * 1. 在原始栈上保存r4-r7、lr
+ * 2. r7为加载基址：运行地址减去链接地址（镜像链接在0地址）
+ * 3. r4指向该导出函数在.exports中的记录，之后进入enter(默认__pic_enter)
+ * 记录中的got片段表由scripts/gotslice.py生成，未生成时弱符号为0
+ */
+.macro PIC_VENEER veneer, func, enter=__pic_enter
+	.pushsection .exports, "aw"
+	.p2align 3
+.Lrec_\func:
+	.word \veneer
+	.word \func
+	.word .Lname_\func
+	.word 0			/* calls */
+	.word 0, 0		/* ticks */
+	.word 0			/* ticks_max */
+	.word 0			/* last_error */
+	.word __got_slices_\func	/* PIC_GOT_SLICES关闭时为0 */
+	.word 0
+	.popsection
+	.weak __got_slices_\func
+
+	.pushsection .rodata.exports, "a"
+.Lname_\func:
+	.asciz "\func"
+	.popsection
+
+	.globl \veneer
+	.type \veneer, %function
+	.p2align 2
+\veneer:
+	stmfd sp!, {r4-r7, lr}
+.Lbase_\func:
+	sub r7, pc, #8
+	ldr r4, =.Lbase_\func
+	sub r7, r4
+	ldr r4, =.Lrec_\func
+	add r4, r7
+	b \enter
+	.ltorg
+	.size \veneer, .-\veneer
+.endm
+
+/* 普通导出函数，veneer名为<func>_entry */
+.macro PIC_EXPORT func
+	.section .text.export.\func, "ax"
+	PIC_VENEER \func\()_entry, \func
+.endm
+
+#endif
+
+#endif
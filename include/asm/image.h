@@ -0,0 +1,10 @@
+#ifndef __ASM_IMAGE_H
+#define __ASM_IMAGE_H
+
+/* struct pic_image_header 各成员偏移，见 image.h */
+#define IMAGE_MAGIC	  0x49434950 /* "PICI" */
+#define IMAGE_RO_SIZE 4
+#define IMAGE_DIGEST  8
+#define IMAGE_SIZE	  40
+
+#endif
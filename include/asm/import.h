@@ -0,0 +1,45 @@
+#ifndef __ASM_IMPORT_H
+#define __ASM_IMPORT_H
+
+/* struct pic_import 各成员偏移，见 import.h */
+#define IMPORT_NAME 0
+#define IMPORT_SLOT 4
+#define IMPORT_SIZE 8
+
+#ifdef __ASSEMBLY__
+
+/*
+ * 从共享blob导入的函数
+ * 1. .imports中的记录：函数名偏移及加载时由pic_import_resolve填写的函数地址
+ * 2. 同名stub通过与记录的相对距离找到地址并跳转，只使用ip
+ */
+.macro PIC_IMPORT func
+	.pushsection .imports, "aw"
+	.p2align 2
+.Limp_\func:
+	.word .Limpname_\func
+	.word 0
+	.popsection
+
+	.pushsection .rodata.imports, "a"
+.Limpname_\func:
+	.asciz "\func"
+	.popsection
+
+	.section .text.import.\func, "ax"
+	.globl \func
+	.type \func, %function
+	.p2align 2
+\func:
+	ldr ip, .Lrel_\func
+.Lpc_\func:
+	add ip, pc, ip
+	ldr pc, [ip, #IMPORT_SLOT]
+.Lrel_\func:
+	.word .Limp_\func - (.Lpc_\func + 8)
+	.size \func, .-\func
+.endm
+
+#endif
+
+#endif
@@ -62,6 +62,42 @@
 #ifndef _BSP_H_
 #define _BSP_H_
 
+/*
+ * Base address of the system registers and offsets of the registers
+ * (see section 4.3 of the DUI0225D):
+ */
+#define BSP_SYSREG_BASE_ADDRESS (0x10000000)
+
+#define BSP_SYS_ID		   (0x00) /* board identification */
+#define BSP_SYS_SW		   (0x04) /* user switches */
+#define BSP_SYS_LED		   (0x08) /* user LEDs */
+#define BSP_SYS_OSC0	   (0x0C) /* oscillator 0-4 settings, 4 bytes apart */
+#define BSP_SYS_LOCK	   (0x20) /* lock of the oscillator and reset registers */
+#define BSP_SYS_100HZ	   (0x24) /* 100 Hz counter */
+#define BSP_SYS_CFGDATA1   (0x28)
+#define BSP_SYS_CFGDATA2   (0x2C)
+#define BSP_SYS_FLAGS	   (0x30) /* general purpose flags, cleared on reset */
+#define BSP_SYS_FLAGSSET   (0x30)
+#define BSP_SYS_FLAGSCLR   (0x34)
+#define BSP_SYS_NVFLAGS	   (0x38) /* flags kept across a reset */
+#define BSP_SYS_NVFLAGSSET (0x38)
+#define BSP_SYS_NVFLAGSCLR (0x3C)
+#define BSP_SYS_RESETCTL   (0x40)
+#define BSP_SYS_PCICTL	   (0x44)
+#define BSP_SYS_MCI		   (0x48)
+#define BSP_SYS_FLASH	   (0x4C) /* flash write protection */
+#define BSP_SYS_CLCD	   (0x50)
+#define BSP_SYS_CLCDSER	   (0x54)
+#define BSP_SYS_BOOTCS	   (0x58)
+#define BSP_SYS_24MHZ	   (0x5C) /* free-running 24 MHz counter, read only */
+#define BSP_SYS_MISC	   (0x60)
+#define BSP_SYS_DMAPSR0	   (0x64) /* DMA peripheral map, 0-2 4 bytes apart */
+#define BSP_SYS_OSCRESET0  (0x8C) /* oscillator 0-4 reset values */
+#define BSP_SYS_TEST_OSC0  (0xC0) /* oscillator 0-4 test counters */
+
+/* Frequency of the SYS_24MHZ counter */
+#define BSP_SYS_24MHZ_HZ (24000000)
+
 /* Base address of the Primary Interrupt Controller (see page 4-44 of the
  * DUI0225D): */
 #define BSP_PIC_BASE_ADDRESS (0x10140000)
@@ -70,6 +106,13 @@
  * DUI0225D): */
 #define BSP_SIC_BASE_ADDRESS (0x10003000)
 
+/* Interrupt controller registers, offsets from the base */
+#define BSP_PIC_IRQSTATUS (0x00) /* enabled and pending IRQs */
+#define BSP_SIC_STATUS	  (0x00) /* enabled and pending SIC interrupts */
+
+/* Line of the Primary Interrupt Controller the SIC is cascaded to */
+#define BSP_PIC_SIC_IRQ (31)
+
 /*
  * Base addresses and IRQs of all 3 UARTs
  * (see page 4-68 of the DUI0225D):
@@ -119,6 +162,30 @@
 
 #define BSP_WATCHDOG_IRQ		  (0)
 
+/*
+ * Base address and IRQ of the DMA controller (PL080)
+ * (see the memory map in chapter 4 of the DUI0225D):
+ */
+#define BSP_DMAC_BASE_ADDRESS (0x10130000)
+
+#define BSP_DMAC_IRQ		  (17)
+
+/*
+ * Base address of the Advanced Audio CODEC Interface (PL041) and its IRQ on
+ * the Secondary Interrupt Controller (see pp. 4-44 and 4-50 of the DUI0225D):
+ */
+#define BSP_AACI_BASE_ADDRESS (0x10004000)
+
+#define BSP_AACI_SIC_IRQ	  (24)
+
+/*
+ * Base address and size of the NOR flash, two Intel StrataFlash devices on
+ * a 32-bit bus (see page 4-5 of the DUI0225D):
+ */
+#define BSP_FLASH_BASE_ADDRESS (0x34000000)
+
+#define BSP_FLASH_SIZE		   (0x04000000)
+
 /*
  * IRQ, reserved for software generated interrupts.
  * See pp.4-46 to 4-48 of the DUI0225D.
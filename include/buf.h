@@ -0,0 +1,69 @@
+/**
+ * @file
+ *
+ * Reference counted buffer chains, shared across the I/O layers.
+ *
+ * A buffer is a pool block starting with a struct buf descriptor, followed
+ * by its data area. Allocation leaves BUF_HEADROOM bytes in front of the
+ * data, so a layer can prepend its header in place with buf_push() instead
+ * of copying the payload into a new buffer. A record larger than a block is
+ * a chain of buffers linked by 'next'.
+ *
+ * buf_ref() lets several consumers hold the same chain, e.g. to send one
+ * record both to a UART and to the host. A chain referenced more than once
+ * must be treated as read-only, each consumer releases it by buf_free().
+ * Nothing here is interrupt safe, see pool.h.
+ */
+
+#ifndef _BUF_H_
+#define _BUF_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <types.h>
+#include <pool.h>
+#include <iovec.h>
+
+/* Room reserved in front of the data for headers of the lower layers */
+#define BUF_HEADROOM (16)
+
+struct buf {
+	struct pool *pool; /* pool the buffer is returned to */
+	struct buf *next;  /* next segment of the chain, NULL for the last one */
+	u8 *data;		   /* first valid byte */
+	u32 len;		   /* number of valid bytes */
+	u8 *end;		   /* end of the data area */
+	u32 refcnt;		   /* number of holders of the buffer */
+};
+
+/* Start of the data area */
+#define BUF_HEAD(buf) ((u8 *)((struct buf *)(buf) + 1))
+
+/* Bytes available in front of, and behind the valid data */
+#define buf_headroom(buf) ((u32)((buf)->data - BUF_HEAD(buf)))
+#define buf_tailroom(buf) ((u32)((buf)->end - (buf)->data - (buf)->len))
+
+struct buf *buf_alloc(struct pool *pool);
+
+void buf_free(struct buf *chain);
+
+struct buf *buf_ref(struct buf *chain);
+
+u8 *buf_push(struct buf *buf, u32 len);
+
+u8 *buf_pull(struct buf *buf, u32 len);
+
+u8 *buf_put(struct buf *buf, u32 len);
+
+void buf_append(struct buf *chain, struct buf *seg);
+
+u32 buf_chain_len(const struct buf *chain);
+
+u32 buf_iov(const struct buf *chain, struct iovec *iov, u32 cnt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _BUF_H_ */
@@ -0,0 +1,49 @@
+/**
+ * @file
+ *
+ * ARM926EJ-S cache maintenance by modified virtual address (MVA).
+ *
+ * See chapter 2.3.8 (Register 7, cache operations) of the ARM926EJ-S
+ * Technical Reference Manual (DDI0198E):
+ * http://infocenter.arm.com/help/topic/com.arm.doc.ddi0198e/DDI0198E_arm926ejs_r0p5_trm.pdf
+ */
+
+#ifndef _CACHE_H_
+#define _CACHE_H_
+
+#include <types.h>
+
+#define CACHE_LINE_SIZE (32)
+
+/*
+ * Waits until all writes posted to the write buffer have completed, e.g.
+ * before reading a status register that depends on them.
+ */
+static inline void cache_drain_write_buffer(void)
+{
+	__asm__ volatile("mcr p15, 0, %0, c7, c10, 4" : : "r"(0) : "memory");
+}
+
+/*
+ * Makes instructions written as data in [start, start + len) visible to
+ * instruction fetch: the D-cache lines are cleaned, the write buffer is
+ * drained and the I-cache lines are invalidated.
+ */
+static inline void cache_sync_icache(const void *start, u32 len)
+{
+	u32 first = (u32)start & ~(CACHE_LINE_SIZE - 1);
+	u32 end = (u32)start + len;
+	u32 mva;
+
+	/* clean D-cache lines by MVA */
+	for (mva = first; mva < end; mva += CACHE_LINE_SIZE) {
+		__asm__ volatile("mcr p15, 0, %0, c7, c10, 1" : : "r"(mva) : "memory");
+	}
+	cache_drain_write_buffer();
+	/* invalidate I-cache lines by MVA */
+	for (mva = first; mva < end; mva += CACHE_LINE_SIZE) {
+		__asm__ volatile("mcr p15, 0, %0, c7, c5, 1" : : "r"(mva) : "memory");
+	}
+}
+
+#endif /* _CACHE_H_ */
@@ -0,0 +1,59 @@
+/**
+ * @file
+ *
+ * CFI parallel NOR flash with the Intel/Sharp command set (as on the
+ * baseboard and QEMU's -pflash), one or two x16 devices on a 32-bit bus.
+ *
+ * Erase and program operations are only started by cfi_flash_eraseStart()
+ * and cfi_flash_programStart(), cfi_flash_poll() completes them, so a
+ * sector erase (up to a second) never blocks the caller. Programming uses
+ * the devices' write buffers, a buffer of up to CFI_BUFFER_MAX bytes per
+ * device is programmed by one operation. One operation is in progress at a
+ * time, the array cannot be read meanwhile.
+ */
+
+#ifndef _CFI_FLASH_H_
+#define _CFI_FLASH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <types.h>
+
+/* Write buffer used per device, smaller buffers reported by CFI are used */
+#define CFI_BUFFER_MAX (32)
+
+/* Return values, an operation is in progress or an error */
+#define CFI_BUSY	 (1)
+#define CFI_ENODEV	 (-1) /* no CFI flash with a supported command set */
+#define CFI_EINVAL	 (-2) /* misaligned or out of range */
+#define CFI_EPROGRAM (-3) /* program failed */
+#define CFI_EERASE	 (-4) /* erase failed */
+#define CFI_ELOCKED	 (-5) /* the sector is locked */
+
+struct cfi_flash {
+	volatile u32 *base; /* the array, mapped */
+	u32 size;			/* bytes */
+	u32 sector_size;	/* bytes of an erase sector of the bank */
+	u32 buffer_size;	/* bytes of the bank programmed per operation */
+	u32 rep;			/* multiplier replicating a command to each device */
+	u8 op;				/* operation in progress */
+	u32 errors;			/* failed operations */
+};
+
+int cfi_flash_probe(struct cfi_flash *f, u32 base);
+
+int cfi_flash_eraseStart(struct cfi_flash *f, u32 offset);
+
+int cfi_flash_programStart(struct cfi_flash *f, u32 offset, const void *data,
+						   u32 len);
+
+int cfi_flash_poll(struct cfi_flash *f);
+
+int cfi_flash_read(struct cfi_flash *f, u32 offset, void *buf, u32 len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _CFI_FLASH_H_ */
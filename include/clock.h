@@ -0,0 +1,63 @@
+/**
+ * @file
+ *
+ * High resolution timestamps from the free-running SYS_24MHZ counter of the
+ * system registers (about 42 ns per tick). The counter needs no setup and
+ * no interrupt, clock_read() is a single load.
+ *
+ * clock_now() extends the counter to 64 bits by detecting its wraps, which
+ * happen every 179 s, so it must be called at least that often. Tick deltas
+ * are converted with multiply and shift constants derived from CLOCK_HZ at
+ * compile time, no division is done at run time.
+ */
+
+#ifndef _CLOCK_H_
+#define _CLOCK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <types.h>
+#include <bsp.h>
+
+/* frequency of the counter, override it for a measured board clock */
+#ifndef CLOCK_HZ
+#define CLOCK_HZ BSP_SYS_24MHZ_HZ
+#endif
+
+/* ns = ticks * CLOCK_NS_MULT >> CLOCK_NS_SHIFT, exact to 1e-9 */
+#define CLOCK_NS_SHIFT (24)
+#define CLOCK_NS_MULT                                                          \
+	((u32)(((1000000000ull << CLOCK_NS_SHIFT) + CLOCK_HZ / 2) / CLOCK_HZ))
+
+/* us = ticks * CLOCK_US_MULT >> 32 */
+#define CLOCK_US_MULT ((u32)(((1000000ull << 32) + CLOCK_HZ / 2) / CLOCK_HZ))
+
+/* @return the 32-bit counter, it counts up */
+static inline u32 clock_read(void)
+{
+	return *(volatile const u32 *)(BSP_SYSREG_BASE_ADDRESS + BSP_SYS_24MHZ);
+}
+
+/* @return 'ticks' of the counter in nanoseconds */
+static inline u64 clock_toNs(u32 ticks)
+{
+	return ((u64)ticks * CLOCK_NS_MULT) >> CLOCK_NS_SHIFT;
+}
+
+/* @return 'ticks' of the counter in microseconds */
+static inline u32 clock_toUs(u32 ticks)
+{
+	return (u32)(((u64)ticks * CLOCK_US_MULT) >> 32);
+}
+
+/* @return ticks of 'us' microseconds, at most 178956970 */
+static inline u32 clock_fromUs(u32 us) { return us * (CLOCK_HZ / 1000000); }
+
+u64 clock_now(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _CLOCK_H_ */
@@ -0,0 +1,35 @@
+/**
+ * @file
+ *
+ * Hex and base64 encoders and decoders for channels that only carry
+ * printable text. Encoding is table driven: one 16-bit lookup yields both
+ * hex digits of a byte, and the encoders store whole halfwords or words
+ * whenever the destination is aligned. The functions are plain C and build
+ * for the host as well.
+ */
+
+#ifndef _CODEC_H_
+#define _CODEC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <types.h>
+
+/* Characters of the encoding of 'len' bytes */
+#define HEX_LEN(len)	((len) * 2)
+#define BASE64_LEN(len) (((len) + 2) / 3 * 4)
+
+u32 hex_encode(char *dst, const void *src, u32 len);
+
+u32 hex_decode(void *dst, const char *src, u32 len);
+
+u32 base64_encode(char *dst, const void *src, u32 len);
+
+u32 base64_decode(void *dst, const char *src, u32 len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _CODEC_H_ */
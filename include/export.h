@@ -0,0 +1,85 @@
+/**
+ * @file
+ *
+ * Table of functions exported to the host.
+ *
+ * Every export has an entry veneer (see asm/export.h), the host calls the
+ * veneer at its offset from the load address. The veneer switches to the
+ * internal stack and accounts each call in the export's record. Records are
+ * placed between the __exports_start__ and __exports_end__ linker symbols,
+ * so the host can read the statistics directly from the loaded image.
+ *
+ * Exported functions take up to four word arguments and return an int,
+ * negative values are error codes.
+ *
+ * With PIC_GOT_SLICES, an export relocates only the GOT slots reachable from
+ * it, on its first call at a load address. The slots are grouped into
+ * slices by the set of exports using them (scripts/gotslice.py), each slice
+ * records the base it has been relocated to.
+ *
+ * Every call runs on one of PIC_STACK_SLOTS internal stacks, so the exports
+ * may be entered again from an interrupt while a call is active. If all
+ * stacks are in use the veneer returns PIC_EBUSY without calling the export.
+ *
+ * A long computation may call pic_yield() to give the time slice back: the
+ * export returns PIC_PENDING to the host, its internal stack stays claimed,
+ * and the host continues it later by calling pic_resume_entry, which returns
+ * what the export eventually returns (or PIC_PENDING again). The image must
+ * not move in between. One computation can be suspended at a time, the
+ * statistics of its export count the whole time until it completes.
+ */
+
+#ifndef _EXPORT_H_
+#define _EXPORT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <types.h>
+#include <asm/export.h>
+
+/* SP804 counter used to time the exports (the last one of the board) */
+#define EXPORT_TIMER_NR	 (1)
+#define EXPORT_TIMER_CTR (1)
+
+/*
+ * Offsets are relative to the image, i.e. to the load address, as the image
+ * is linked at address 0.
+ */
+struct pic_export {
+	u32 veneer;		/* offset of the entry veneer */
+	u32 func;		/* offset of the exported function */
+	u32 name;		/* offset of the '\0' terminated name */
+	u32 calls;		/* number of completed calls */
+	u64 ticks;		/* cumulative time spent in the function */
+	u32 ticks_max;	/* longest single call */
+	s32 last_error; /* last negative value returned, 0 if none */
+	/*
+	 * offset of the GOT slices the export uses (PIC_GOT_SLICES): their
+	 * number, then the offset of each; 0 if the whole GOT is relocated
+	 */
+	u32 slices;
+	u32 reserved;
+};
+
+_Static_assert(sizeof(struct pic_export) == EXPORT_SIZE,
+			   "struct pic_export does not match asm/export.h");
+
+extern struct pic_export __exports_start__[];
+extern struct pic_export __exports_end__[];
+
+u32 export_begin(void);
+
+void export_end(struct pic_export *exp, u32 start, s32 ret);
+
+/*
+ * Suspends the calling export, see above. Returns 0 once resumed, or
+ * PIC_EBUSY at once if another computation is suspended.
+ */
+int pic_yield(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _EXPORT_H_ */
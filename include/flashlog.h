@@ -0,0 +1,89 @@
+/**
+ * @file
+ *
+ * Log-structured append store on a range of CFI flash sectors, for trace
+ * and log records and for staging blob images.
+ *
+ * flashlog_append() only copies a record into a RAM ring and returns, the
+ * record reaches the flash as flashlog_poll() is called from the idle loop
+ * or the pipeline: each call at most completes one flash operation and
+ * starts the next one (a buffered program or a sector erase), so appending
+ * never waits for the flash.
+ *
+ * The sectors are written in turn, each starts with a header holding its
+ * sequence number. When the log moves on to the next sector that sector is
+ * erased, dropping the oldest records. flashlog_mount() finds the newest
+ * sector and the end of its records, a record torn by a reset is skipped.
+ */
+
+#ifndef _FLASHLOG_H_
+#define _FLASHLOG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stdbool.h>
+#include <types.h>
+#include <cfi_flash.h>
+
+/* Largest record data */
+#define FLASHLOG_REC_MAX (1024)
+
+/* Bytes a record of 'len' data bytes takes in the ring and the flash */
+#define FLASHLOG_REC_SIZE(len) (8 + (((len) + 3) & ~3))
+
+/* Return values */
+#define FLASHLOG_BUSY	(1)	 /* flashlog_poll(): records are being written */
+#define FLASHLOG_END	(-1) /* flashlog_next(): no more records */
+#define FLASHLOG_EFULL	(-2) /* flashlog_append(): the ring is full */
+#define FLASHLOG_EINVAL (-3)
+
+struct flashlog {
+	struct cfi_flash *flash;
+	u32 first;		/* offset of the first sector */
+	u32 nr_sectors; /* number of sectors, at least 2 */
+	u8 *ring;		/* staged records */
+	u32 mask;		/* ring size - 1, a power of 2 */
+	u32 head;		/* incremented by flashlog_append() */
+	u32 tail;		/* incremented as records are programmed */
+	u32 cur;		/* index of the sector being written */
+	u32 seq;		/* its sequence number */
+	u32 base;		/* sequence number of the oldest sector of the log */
+	u32 prog;		/* offset of the next byte programmed */
+	u32 rec_left;	/* bytes of the record being programmed */
+	u8 step;		/* what flashlog_poll() does next */
+	u8 pending;		/* step of the flash operation in progress */
+	u32 hdr_done;	/* bytes of the sector header programmed */
+	u32 hdr[4];		/* header of the current sector */
+	u32 records;	/* records appended */
+	u32 dropped;	/* records dropped because the ring was full */
+	u32 errors;		/* failed flash operations */
+};
+
+/* Position of a reader of the log */
+struct flashlog_cursor {
+	u32 seq; /* sequence number of the sector */
+	u32 off; /* offset of the next record in the sector */
+};
+
+int flashlog_init(struct flashlog *log, struct cfi_flash *flash, u32 first,
+				  u32 nr_sectors, void *ring, u32 ring_size);
+
+int flashlog_mount(struct flashlog *log);
+
+void flashlog_format(struct flashlog *log);
+
+int flashlog_append(struct flashlog *log, u8 type, const void *data, u32 len);
+
+int flashlog_poll(struct flashlog *log);
+
+void flashlog_rewind(const struct flashlog *log, struct flashlog_cursor *c);
+
+int flashlog_next(const struct flashlog *log, struct flashlog_cursor *c,
+				  u8 *type, void *buf, u32 max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FLASHLOG_H_ */
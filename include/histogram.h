@@ -0,0 +1,84 @@
+/**
+ * @file
+ *
+ * Log-linear latency histograms (HDR style).
+ *
+ * Every power of 2 range of values is split into HIST_SUB linear buckets, so
+ * a bucket is never wider than 1/HIST_SUB of its values (12.5%) and the whole
+ * u32 range fits in HIST_BUCKETS counters. The bucket of a value is found
+ * with one CLZ, recording is a handful of instructions:
+ *
+ *     HISTOGRAM(uart_latency, "uart write");
+ *
+ *     histogram_record(&uart_latency, ticks);
+ *
+ * Histograms are placed between the __histograms_start__ and
+ * __histograms_end__ linker symbols, the host reads them from the loaded
+ * image and extracts the percentiles (scripts/histreport.py).
+ */
+
+#ifndef _HISTOGRAM_H_
+#define _HISTOGRAM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <types.h>
+
+/* log2 of the number of linear buckets per power of 2 */
+#define HIST_SUB_BITS (3)
+#define HIST_SUB	  (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS  ((32 - HIST_SUB_BITS + 1) * HIST_SUB)
+
+struct histogram {
+	/*
+	 * offset of the '\0' terminated name in the image: static pointers are
+	 * not relocated and the image is linked at address 0
+	 */
+	const char *name;
+	u32 count; /* number of values recorded */
+	u32 max;   /* largest value recorded */
+	u32 buckets[HIST_BUCKETS];
+};
+
+/* defines a histogram in the host readable area */
+#define HISTOGRAM(var, label)                                                  \
+	struct histogram var                                                       \
+		__attribute__((section(".histograms"), aligned(4))) = {.name = label}
+
+extern struct histogram __histograms_start__[];
+extern struct histogram __histograms_end__[];
+
+/* bucket of 'value': values below HIST_SUB have one bucket each */
+static inline u32 histogram_index(u32 value)
+{
+	u32 shift;
+
+	if (value < HIST_SUB) {
+		return value;
+	}
+	shift = 31 - HIST_SUB_BITS - __builtin_clz(value);
+
+	return ((shift + 1) << HIST_SUB_BITS) + ((value >> shift) & (HIST_SUB - 1));
+}
+
+static inline void histogram_record(struct histogram *h, u32 value)
+{
+	h->buckets[histogram_index(value)]++;
+	h->count++;
+	if (value > h->max) {
+		h->max = value;
+	}
+}
+
+void histogram_reset(struct histogram *h);
+
+u32 histogram_bucketLow(u32 index);
+
+u32 histogram_percentile(const struct histogram *h, u32 permille);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HISTOGRAM_H_ */
@@ -0,0 +1,37 @@
+/**
+ * @file
+ *
+ * Image header, placed right after the _start veneer. The host loader checks
+ * the digest of the read-only part of the image before calling _start, the
+ * blob itself can check it again with image_verify().
+ */
+
+#ifndef _IMAGE_H_
+#define _IMAGE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <types.h>
+#include <asm/image.h>
+#include <sha256.h>
+
+struct pic_image_header {
+	u32 magic;	 /* IMAGE_MAGIC */
+	u32 ro_size; /* bytes covered by the digest, from the image start */
+	/* SHA-256 of [0, ro_size), with this field taken as zeros */
+	u8 digest[SHA256_DIGEST_SIZE];
+};
+
+_Static_assert(sizeof(struct pic_image_header) == IMAGE_SIZE,
+			   "struct pic_image_header does not match asm/image.h");
+
+extern const struct pic_image_header __image_header;
+
+int image_verify(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _IMAGE_H_ */
@@ -0,0 +1,52 @@
+/**
+ * @file
+ *
+ * Functions imported from a shared blob (see PIC_SHARED_DRIVER).
+ *
+ * Calls to an imported function go through a stub (see asm/import.h) that
+ * jumps to the address in the import's slot. The host writes the load
+ * address of the shared blob to __pic_lib before the first call into the
+ * payload, the slots are then filled in by pic_import_resolve() when the
+ * payload initializes.
+ */
+
+#ifndef _IMPORT_H_
+#define _IMPORT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <types.h>
+#include <asm/import.h>
+#include <export.h>
+
+struct pic_import {
+	u32 name; /* offset of the '\0' terminated name */
+	u32 slot; /* address of the function in the shared blob */
+};
+
+_Static_assert(sizeof(struct pic_import) == IMPORT_SIZE,
+			   "struct pic_import does not match asm/import.h");
+
+/* Returned by the entry of a shared blob */
+struct pic_export_table {
+	struct pic_export *start;
+	struct pic_export *end;
+};
+
+extern struct pic_import __imports_start__[];
+extern struct pic_import __imports_end__[];
+
+/* Load address of this image, see startup.S */
+extern u32 __pic_base;
+
+/* Load address of the shared blob, written by the host */
+extern u32 __pic_lib;
+
+int pic_import_resolve(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _IMPORT_H_ */
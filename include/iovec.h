@@ -0,0 +1,17 @@
+/**
+ * @file
+ *
+ * Scatter/gather element, describes one contiguous piece of a transfer.
+ */
+
+#ifndef _IOVEC_H_
+#define _IOVEC_H_
+
+#include <types.h>
+
+struct iovec {
+	const void *iov_base;
+	u32 iov_len;
+};
+
+#endif /* _IOVEC_H_ */
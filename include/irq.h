@@ -0,0 +1,39 @@
+/**
+ * @file
+ *
+ * Masking of IRQs around short critical sections shared by the thread and
+ * interrupt contexts (every export may be entered again from an interrupt).
+ * Masking has no effect in user mode, where the CPSR control bits are not
+ * writable.
+ */
+
+#ifndef _IRQ_H_
+#define _IRQ_H_
+
+#include <types.h>
+
+/*
+ * Masks IRQs.
+ *
+ * @return the CPSR before, for irq_restore()
+ */
+static inline u32 irq_save(void)
+{
+	u32 cpsr, masked;
+
+	__asm__ volatile("mrs %0, cpsr\n"
+					 "orr %1, %0, #0x80\n"
+					 "msr cpsr_c, %1\n"
+					 : "=r"(cpsr), "=r"(masked)
+					 :
+					 : "memory");
+	return cpsr;
+}
+
+/* Restores the IRQ mask saved by irq_save() */
+static inline void irq_restore(u32 cpsr)
+{
+	__asm__ volatile("msr cpsr_c, %0" : : "r"(cpsr) : "memory");
+}
+
+#endif /* _IRQ_H_ */
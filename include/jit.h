@@ -0,0 +1,68 @@
+/**
+ * @file
+ *
+ * Runtime code specializer.
+ *
+ * Kernels whose parameters are only known at run time (FIR taps, patterns,
+ * strides) are emitted as straight-line ARM code into an arena, with the
+ * parameters folded into the instructions and all loops unrolled. Variants
+ * are cached by their parameters, so asking again for the same kernel
+ * returns the code generated before.
+ *
+ * When the arena or the variant table is full, the whole cache is flushed:
+ * all code returned before becomes invalid.
+ */
+
+#ifndef _JIT_H_
+#define _JIT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <types.h>
+#include <arena.h>
+
+/* Number of variants a cache holds */
+#define JIT_CACHE_SIZE (16)
+
+/* sum(taps[i] * x[i]) over the taps the kernel was generated for */
+typedef s32 (*jit_fir_fn)(const s16 *x);
+
+/* Copies the words src[0], src[ss], ... to dst[0], dst[ds], ... */
+typedef void (*jit_copy_fn)(u32 *dst, const u32 *src);
+
+/* Returns non-zero if 'p' starts with the pattern */
+typedef int (*jit_match_fn)(const u8 *p);
+
+struct jit_entry {
+	u32 kind;
+	u32 hash;
+	u32 len;		 /* size of the parameters */
+	const u8 *param; /* copy of the parameters, in the arena */
+	void *fn;
+};
+
+struct jit_cache {
+	struct arena *arena;
+	struct jit_entry entries[JIT_CACHE_SIZE];
+	u32 nr_entries;
+	u32 hits;
+	u32 misses;
+};
+
+void jit_init(struct jit_cache *cache, struct arena *arena);
+
+void jit_flush(struct jit_cache *cache);
+
+jit_fir_fn jit_fir(struct jit_cache *cache, const s16 *taps, u32 ntaps);
+
+jit_copy_fn jit_copy(struct jit_cache *cache, u32 count, u32 dst_stride,
+					 u32 src_stride);
+
+jit_match_fn jit_match(struct jit_cache *cache, const u8 *pattern, u32 len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JIT_H_ */
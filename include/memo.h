@@ -0,0 +1,130 @@
+/**
+ * @file
+ *
+ * Memoization of pure functions, e.g. exports the host calls again and
+ * again with the same configuration or table.
+ *
+ * A call is keyed by up to MEMO_ARGS argument words and an input buffer,
+ * memo_hash() hashes both with xxh32(). A hit compares the input with the
+ * cached copy and copies the cached result, so a repeated call costs a hash,
+ * a compare and a copy. The cache has nr_slots open addressed slots, a key is
+ * looked up in MEMO_PROBE of them from its hash; when they are all used the
+ * least recently hit one is evicted. Inputs and results share a ring of
+ * 'budget' bytes, a new entry evicts the ones it overwrites. Each function
+ * that opts in gets its own cache:
+ *
+ *     MEMO(memo_crc, "crc", 16, 4 * (256 + 1024));
+ *
+ *     struct memo_key k = {.args = {poly}, .in = data, .len = len};
+ *
+ *     memo_hash(&k);
+ *     if (MEMO_MISS == memo_get(&memo_crc, &k, &ret, table, sizeof(table))) {
+ *         ret = crc_table(poly, data, len, table);
+ *         memo_put(&memo_crc, &k, ret, table, sizeof(table));
+ *     }
+ *
+ * Slots and results are kept in .noinit, which is not cleared when the blob
+ * moves: the cache survives until the image changes, its salt is taken from
+ * the image digest. xxh32() only selects the slots: a key matches if its
+ * argument words and all its input bytes are equal, so colliding inputs,
+ * even chosen ones, never get each other's result. A cache is used from one
+ * context at a time.
+ *
+ * Caches are placed between the __memos_start__ and __memos_end__ linker
+ * symbols, the host reads the hit and miss counts from the loaded image.
+ */
+
+#ifndef _MEMO_H_
+#define _MEMO_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <types.h>
+
+/* Argument words of a key */
+#define MEMO_ARGS (4)
+
+/* Slots a key may occupy, from the slot its hash selects */
+#define MEMO_PROBE (4)
+
+/* memo_get(): the key is not cached */
+#define MEMO_MISS (-1)
+
+struct memo_key {
+	u32 args[MEMO_ARGS]; /* unused words must be 0 */
+	const void *in;		 /* input bytes, may be NULL if 'len' is 0 */
+	u32 len;
+	u32 hash; /* set by memo_hash() */
+};
+
+struct memo_slot {
+	u32 hash;
+	u32 len; /* of the input */
+	u32 args[MEMO_ARGS];
+	s32 ret;
+	u32 stamp; /* memo clock of the last hit, 0 if the slot is empty */
+	u32 off;   /* of the entry in the ring: the input, then the result */
+	u32 size;  /* bytes of the result */
+};
+
+/* Header of the storage in .noinit, the slots and the ring follow */
+struct memo_store {
+	u32 magic;
+	u32 salt;	  /* from the image digest */
+	u32 nr_slots; /* shape the storage was laid out for */
+	u32 budget;
+	u32 clock;
+	u32 head; /* offset in the ring of the next result */
+};
+
+struct memo {
+	/*
+	 * offsets of the '\0' terminated name and of the storage in the image:
+	 * static pointers are not relocated and the image is linked at address 0
+	 */
+	const char *name;
+	struct memo_store *store;
+	u32 nr_slots; /* a power of 2 */
+	u32 budget;	  /* bytes of the ring, a multiple of 4 */
+	u32 hits;
+	u32 misses;
+	u32 inserts;
+	u32 evictions; /* results dropped for new ones */
+};
+
+/*
+ * 'slots' a power of 2, 'bytes' of inputs and results a multiple of 4, each
+ * input and result takes a multiple of 4 bytes
+ */
+#define MEMO(var, label, slots, bytes)                                         \
+	static struct {                                                            \
+		struct memo_store hdr;                                                 \
+		struct memo_slot slot[slots];                                          \
+		u8 ring[bytes];                                                        \
+	} var##_store __attribute__((section(".noinit." #var), aligned(4)));       \
+	struct memo var __attribute__((section(".memos"), aligned(4))) = {         \
+		.name = label,                                                         \
+		.store = &var##_store.hdr,                                             \
+		.nr_slots = (slots),                                                   \
+		.budget = (bytes),                                                     \
+	}
+
+extern struct memo __memos_start__[];
+extern struct memo __memos_end__[];
+
+void memo_hash(struct memo_key *k);
+
+int memo_get(struct memo *m, const struct memo_key *k, s32 *ret, void *out,
+			 u32 max);
+
+void memo_put(struct memo *m, const struct memo_key *k, s32 ret,
+			  const void *out, u32 size);
+
+void memo_reset(struct memo *m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MEMO_H_ */
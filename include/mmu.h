@@ -0,0 +1,53 @@
+/**
+ * @file
+ *
+ * Flat (identity) page table for the blob, built when PIC_MMU is defined.
+ *
+ * Without the MMU every data access of the ARM926EJ-S is strongly ordered, so
+ * each store to a device register stalls until it has completed. With the
+ * blob's own table RAM and the PL011/PL080 registers are bufferable: stores
+ * are posted to the write buffer, and drivers drain it where ordering matters
+ * (cache_drain_write_buffer()).
+ *
+ * The table is only used if the host runs with the MMU off, a host that has
+ * its own mapping keeps it. With PIC_HIGH_VECTORS the table also maps the
+ * blob's vector page at MMU_HIGH_VECTORS (vectors.h).
+ */
+
+#ifndef _MMU_H_
+#define _MMU_H_
+
+#include <types.h>
+
+/* Level 1 descriptors (DDI0198E, 3.2) */
+#define MMU_L1_ENTRIES (4096)
+#define MMU_L1_SIZE	   (MMU_L1_ENTRIES * 4)
+#define MMU_L1_COARSE  (0x00000011) /* coarse page table, bit 4 set */
+#define MMU_L1_SECTION (0x00000012) /* 1MB section, bit 4 set */
+#define MMU_SECTION_AP (0x00000C00) /* read/write, all modes */
+
+/* Level 2 (coarse) descriptors, 4KB small pages */
+#define MMU_L2_ENTRIES (256)
+#define MMU_L2_SIZE	   (MMU_L2_ENTRIES * 4)
+#define MMU_L2_SMALL   (0x00000002)
+#define MMU_SMALL_AP   (0x00000FF0) /* read/write for all 4 subpages */
+#define MMU_PAGE_SIZE  (4096)
+
+#define MMU_C (0x00000008) /* cacheable */
+#define MMU_B (0x00000004) /* bufferable */
+
+/* Control register (c1) bits */
+#define MMU_CTRL_M (0x00000001)
+#define MMU_CTRL_C (0x00000004)
+#define MMU_CTRL_V (0x00002000) /* vectors at MMU_HIGH_VECTORS */
+
+#define MMU_HIGH_VECTORS (0xFFFF0000)
+
+/* Below this address is SDRAM, mapped cacheable and bufferable */
+#define MMU_RAM_END (0x10000000)
+
+void mmu_enter(void);
+
+void mmu_leave(void);
+
+#endif /* _MMU_H_ */
@@ -0,0 +1,75 @@
+/**
+ * @file
+ *
+ * Phase overlaid .bss. Buffers of modes that are never active at the same
+ * time are tagged with their phase, the linker places every phase listed in
+ * PIC_PHASES (CMake) in one OVERLAY, so they share a single address range:
+ *
+ *     static u8 buf[4096] PHASE_BSS(calib);
+ *
+ *     phase_enter(calib);
+ *     ... PHASE_ACCESS(calib, buf)[i] ...
+ *
+ * phase_enter() zeroes the buffers of the phase, whatever the phase before
+ * left there. Tagging a buffer with a phase missing in PIC_PHASES fails to
+ * link (undefined __phase_<name>_start__).
+ *
+ * With PIC_PHASE_CHECK the phases are laid out one after another instead of
+ * overlaid, so an address tells its phase. PHASE_ACCESS() then counts in
+ * phase_faults every access to a buffer that is not in the named phase's
+ * range or whose phase is not active, the shell's phase command prints it.
+ * The benchmarks take their buffers through PHASE_ACCESS() whenever they
+ * hand them to a kernel.
+ */
+
+#ifndef _PHASE_H_
+#define _PHASE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <types.h>
+
+#define PHASE_BSS(phase) __attribute__((section(".bss.phase." #phase)))
+
+/* bounds of a phase, defined by the generated phase.ld */
+#define __PHASE_START(phase) __phase_##phase##_start__
+#define __PHASE_END(phase)	 __phase_##phase##_end__
+#define __PHASE_DECLARE(phase)                                                 \
+	extern u8 __PHASE_START(phase)[], __PHASE_END(phase)[]
+
+#define phase_enter(phase)                                                     \
+	({                                                                         \
+		__PHASE_DECLARE(phase);                                                \
+		__phase_enter(#phase, __PHASE_START(phase), __PHASE_END(phase));       \
+	})
+
+#if defined(PIC_PHASE_CHECK)
+#define PHASE_ACCESS(phase, buf)                                               \
+	({                                                                         \
+		__PHASE_DECLARE(phase);                                                \
+		__typeof__(&(buf)[0]) __buf = (buf);                                   \
+		__phase_check(#phase, (const u8 *)__buf, __PHASE_START(phase),         \
+					  __PHASE_END(phase));                                     \
+		__buf;                                                                 \
+	})
+#else
+#define PHASE_ACCESS(phase, buf) (buf)
+#endif
+
+/* name of the active phase, NULL if none; all phases start at one address */
+extern const char *phase_active;
+
+/* accesses outside the active phase, see PHASE_ACCESS() */
+extern u32 phase_faults;
+
+void __phase_enter(const char *name, u8 *start, u8 *end);
+
+void __phase_check(const char *name, const u8 *p, const u8 *start,
+				   const u8 *end);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PHASE_H_ */
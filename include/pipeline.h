@@ -0,0 +1,145 @@
+/**
+ * @file
+ *
+ * Streaming dataflow pipelines.
+ *
+ * A pipeline is a chain of stages (source -> filter ... -> sink) connected
+ * by queues of buffer chains (see buf.h). Buffers are allocated from a pool
+ * and handed from stage to stage by reference, data is never copied between
+ * stages. Each invocation passes a stage a vector of up to PIPELINE_BATCH
+ * buffers to amortize the call overhead.
+ */
+
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stdbool.h>
+#include <types.h>
+#include <pool.h>
+#include <buf.h>
+#include <histogram.h>
+
+/* Maximum number of buffers passed to a stage per invocation */
+#define PIPELINE_BATCH (8)
+
+/* Segments of a chain transmitted by one uart_writev() in the UART sink */
+#define PIPELINE_IOV (8)
+
+/* Single producer, single consumer queue of buffers */
+struct buf_queue {
+	struct buf **slots;
+	u32 mask;	   /* number of slots - 1, a power of 2 */
+	u32 head;	   /* incremented by the producer */
+	u32 tail;	   /* incremented by the consumer */
+	u32 max_depth; /* high watermark of the queue depth */
+};
+
+struct stage;
+
+/*
+ * Processes 'n' input buffers. Every buffer must be either forwarded with
+ * stage_emit() or released with buf_free(), at most one buffer may be
+ * emitted per input buffer. A source stage has no input queue and is called
+ * with 'bufs' equal to NULL, it may emit up to 'n' buffers.
+ *
+ * Returns the number of bytes processed, for the statistics.
+ */
+typedef u32 (*stage_fn)(struct stage *st, struct buf **bufs, u32 n);
+
+struct stage_stats {
+	u32 calls; /* invocations with work to do */
+	u32 bufs;  /* buffers consumed, or produced by a source */
+	u32 bytes; /* bytes reported by the stage */
+	u32 ticks; /* time spent in the stage, export timer ticks */
+};
+
+struct stage {
+	const char *name;
+	stage_fn fn;
+	void *ctx;			   /* stage specific data */
+	struct buf_queue *in;  /* NULL for a source */
+	struct buf_queue *out; /* NULL for a sink */
+	struct stage_stats stats;
+	/* latency of each invocation, optional: set after stage_init() */
+	struct histogram *hist;
+	struct stage *next;
+};
+
+struct pipeline {
+	struct stage *first;
+	struct stage *last;
+};
+
+/* Encodings of the encoder stage, see codec.h */
+#define PIPELINE_HEX	(0)
+#define PIPELINE_BASE64 (1)
+
+/* Context of the encoder stage */
+struct encode_stage {
+	struct pool *pool; /* buffers of the encoded chains */
+	u8 format;		   /* PIPELINE_HEX or PIPELINE_BASE64 */
+	u32 dropped;	   /* chains dropped because the pool was exhausted */
+};
+
+/* Input formats of the PCM conversion stage, little endian samples */
+#define PIPELINE_PCM_U8			(0) /* unsigned 8-bit mono */
+#define PIPELINE_PCM_S16		(1) /* signed 16-bit mono */
+#define PIPELINE_PCM_S16_STEREO (2) /* signed 16-bit, left then right */
+
+/* Context of the PCM conversion stage */
+struct pcm_stage {
+	struct pool *pool; /* buffers of the converted chains */
+	u8 format;		   /* PIPELINE_PCM_* */
+	u32 dropped;	   /* chains dropped because the pool was exhausted */
+};
+
+/* Context of the AACI sink stage */
+struct aaci_stage {
+	u32 wait; /* ticks spent waiting for room in the ring */
+};
+
+/* Context of the UART source and sink stages */
+struct uart_stage {
+	u8 nr;			   /* number of the UART */
+	struct pool *pool; /* buffers of the source */
+};
+
+void buf_queue_init(struct buf_queue *q, struct buf **slots, u32 nr_slots);
+
+u32 buf_queue_depth(const struct buf_queue *q);
+
+bool buf_queue_put(struct buf_queue *q, struct buf *buf);
+
+struct buf *buf_queue_get(struct buf_queue *q);
+
+void stage_init(struct stage *st, const char *name, stage_fn fn, void *ctx,
+				struct buf_queue *in, struct buf_queue *out);
+
+void stage_emit(struct stage *st, struct buf *buf);
+
+void pipeline_init(struct pipeline *p);
+
+void pipeline_add(struct pipeline *p, struct stage *st);
+
+bool pipeline_step(struct pipeline *p);
+
+u32 pipeline_uart_source(struct stage *st, struct buf **bufs, u32 n);
+
+u32 pipeline_uart_sink(struct stage *st, struct buf **bufs, u32 n);
+
+u32 pipeline_sha256(struct stage *st, struct buf **bufs, u32 n);
+
+u32 pipeline_encode(struct stage *st, struct buf **bufs, u32 n);
+
+u32 pipeline_pcm(struct stage *st, struct buf **bufs, u32 n);
+
+u32 pipeline_aaci_sink(struct stage *st, struct buf **bufs, u32 n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PIPELINE_H_ */
@@ -0,0 +1,41 @@
+/**
+ * @file
+ *
+ * Fixed block size memory pools.
+ *
+ * A pool hands out equally sized blocks carved from a caller provided
+ * memory area. Allocation and release are O(1) list operations. Pools are
+ * not protected against concurrent use, a pool shared with an interrupt
+ * handler must be accessed with interrupts disabled.
+ */
+
+#ifndef _POOL_H_
+#define _POOL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <types.h>
+
+struct pool {
+	void *free;		/* list of free blocks, linked through their first word */
+	u32 block_size; /* size of a block, multiple of 4 */
+	u32 nr_blocks;	/* total number of blocks */
+	u32 nr_free;	/* number of blocks currently free */
+	u32 min_free;	/* low watermark of nr_free */
+};
+
+/* Memory needed by a pool of 'nr' blocks of 'size' bytes */
+#define POOL_MEM_SIZE(size, nr) ((((size) + 3) & ~3) * (nr))
+
+void pool_init(struct pool *pool, void *mem, u32 block_size, u32 nr_blocks);
+
+void *pool_alloc(struct pool *pool);
+
+void pool_free(struct pool *pool, void *block);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _POOL_H_ */
@@ -0,0 +1,73 @@
+/**
+ * @file
+ *
+ * Token bucket rate limiting of console output.
+ *
+ * A limiter lets 'burst' messages through at once and then one message per
+ * 'period' ticks of the export timer, the rest are counted and dropped. The
+ * next message let through is preceded by a "<name>: N messages suppressed"
+ * summary, ratelimit_flush() prints a pending summary from an idle loop.
+ * Limiters are kept per subsystem or per call site:
+ *
+ *     RATELIMIT(rl_dma, "dma", 10, 4);
+ *
+ *     ratelimit_print(&rl_dma, 0, "dma: underrun\n");
+ *
+ * Limiters are placed between the __ratelimits_start__ and
+ * __ratelimits_end__ linker symbols, the host reads the drop counts from the
+ * loaded image.
+ */
+
+#ifndef _RATELIMIT_H_
+#define _RATELIMIT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stdbool.h>
+#include <types.h>
+
+/* frequency of the export timer the buckets are refilled from */
+#define RATELIMIT_HZ (1000000)
+
+struct ratelimit {
+	/*
+	 * offset of the '\0' terminated name in the image: static pointers are
+	 * not relocated and the image is linked at address 0
+	 */
+	const char *name;
+	u32 period;		/* ticks per message */
+	u32 limit;		/* credit of a full bucket, burst * period */
+	u32 credit;		/* ticks of credit left */
+	u32 last;		/* timer value of the last refill */
+	u32 suppressed; /* dropped since the last summary */
+	u32 passed;		/* messages let through */
+	u32 dropped;	/* messages dropped */
+};
+
+/* 'rate' messages per second after a burst of 'burst', starts full */
+#define RATELIMIT(var, label, rate, burst)                                     \
+	struct ratelimit var                                                       \
+		__attribute__((section(".ratelimits"), aligned(4))) = {                \
+			.name = label,                                                     \
+			.period = RATELIMIT_HZ / (rate),                                   \
+			.limit = (burst) * (RATELIMIT_HZ / (rate)),                        \
+			.credit = (burst) * (RATELIMIT_HZ / (rate)),                       \
+	}
+
+extern struct ratelimit __ratelimits_start__[];
+extern struct ratelimit __ratelimits_end__[];
+
+bool ratelimit_allow(struct ratelimit *rl);
+
+void ratelimit_flush(struct ratelimit *rl, u8 nr);
+
+void ratelimit_print(struct ratelimit *rl, u8 nr, const char *str);
+
+void ratelimit_write(struct ratelimit *rl, u8 nr, const void *buf, u32 len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RATELIMIT_H_ */
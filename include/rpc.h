@@ -0,0 +1,93 @@
+/**
+ * @file
+ *
+ * Pipelined remote calls over a UART, the host side is scripts/rpcclient.py.
+ *
+ * Requests and replies are SLIP framed (RFC 1055) and end with the xxh32()
+ * of their other bytes, frames with a bad length or hash are dropped. A
+ * request carries an ID chosen by the host, the number of the function and
+ * its argument words, the reply the same ID, a status and the return value.
+ * The host keeps up to RPC_WINDOW requests outstanding and matches replies
+ * by ID, so the link carries requests while earlier ones execute instead of
+ * idling for a round trip per call.
+ *
+ * Requests are executed in the order they arrived. A function marked 'poll'
+ * is called again on every rpc_poll() while it returns RPC_BUSY and stays in
+ * the window meanwhile, the replies of later requests overtake its reply.
+ * Its last parameter points to a word of state kept with the request, 0 at
+ * the first call, so several requests of it may be in progress at once.
+ *
+ * The functions are listed in a *.rpc file (app/rpcs.rpc), scripts/rpcgen.py
+ * numbers them in order and generates the direct calls below and a python
+ * module with the numbers for the client (pic_rpcs()).
+ */
+
+#ifndef _RPC_H_
+#define _RPC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stdbool.h>
+#include <types.h>
+
+/* Largest number of argument words */
+#define RPC_ARGS (4)
+
+/* Requests received and not yet replied to */
+#define RPC_WINDOW (8)
+
+/* Request: id, function, number of arguments, 0, arguments, hash */
+#define RPC_REQUEST_MAX (4 + 4 * RPC_ARGS + 4)
+/* Reply: id, status, 0, 0, return value, hash */
+#define RPC_REPLY_SIZE (12)
+
+/* Status of a reply */
+#define RPC_OK	   (0)
+#define RPC_ENOENT (1) /* no such function */
+#define RPC_EINVAL (2) /* wrong number of arguments */
+#define RPC_EBUSY  (3) /* the window is full, the request may be sent again */
+
+/* Returned by a poll function while its operation is in progress */
+#define RPC_BUSY (1)
+
+struct rpc_call {
+	u8 id;
+	u8 fn;	   /* number of the function */
+	bool busy; /* received and not yet replied to */
+	u32 args[RPC_ARGS];
+	u32 state; /* of a poll function, 0 at its first call */
+};
+
+struct rpc {
+	u8 nr;		   /* number of the UART */
+	u32 len;	   /* bytes of the frame being received */
+	bool esc;	   /* the previous byte was SLIP ESC */
+	bool overflow; /* the frame is too long, dropped up to its END */
+	u8 frame[RPC_REQUEST_MAX];
+	/* requests in arrival order, from tail to head */
+	u32 head;
+	u32 tail;
+	struct rpc_call window[RPC_WINDOW];
+	u32 calls;	  /* replies sent */
+	u32 rejected; /* requests answered with an error status */
+	u32 dropped;  /* frames with a bad length or hash */
+};
+
+void rpc_init(struct rpc *r, u8 nr);
+
+int rpc_poll(struct rpc *r);
+
+/* generated by scripts/rpcgen.py */
+
+int rpc_nr_args(u32 fn);
+
+bool rpc_isPoll(u32 fn);
+
+int rpc_call(u32 fn, const u32 *args, u32 *state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RPC_H_ */
@@ -0,0 +1,34 @@
+/**
+ * @file
+ *
+ * Byte searches a word at a time (SWAR). Four bytes are tested with a few
+ * ALU operations, the first hit of a word is located with CLZ. The kernels
+ * are plain C and build for the host as well.
+ */
+
+#ifndef _SCAN_H_
+#define _SCAN_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <types.h>
+
+/* Most bytes scan_find_any() searches for at once */
+#define SCAN_SET_MAX (8)
+
+u32 scan_strlen(const char *str);
+
+const void *scan_memchr(const void *buf, u8 c, u32 len);
+
+u32 scan_find_zero(const void *buf, u32 len);
+
+u32 scan_find_any(const void *buf, u32 len, const u8 *set, u32 nset);
+
+u32 scan_count(const void *buf, u32 len, u8 c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SCAN_H_ */
@@ -0,0 +1,37 @@
+/**
+ * @file
+ *
+ * SHA-256 (FIPS 180-4), streaming: data may be passed in pieces of any
+ * size as it arrives, e.g. from a receive pipeline (pipeline_sha256()).
+ */
+
+#ifndef _SHA256_H_
+#define _SHA256_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <types.h>
+
+#define SHA256_BLOCK_SIZE  (64)
+#define SHA256_DIGEST_SIZE (32)
+
+struct sha256 {
+	u32 state[8];
+	u64 len; /* bytes hashed */
+	u8 block[SHA256_BLOCK_SIZE] __attribute__((aligned(4)));
+};
+
+void sha256_init(struct sha256 *ctx);
+
+void sha256_update(struct sha256 *ctx, const void *data, u32 len);
+
+void sha256_final(struct sha256 *ctx, u8 digest[SHA256_DIGEST_SIZE]);
+
+void sha256(const void *data, u32 len, u8 digest[SHA256_DIGEST_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHA256_H_ */
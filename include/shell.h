@@ -0,0 +1,73 @@
+/**
+ * @file
+ *
+ * Line oriented command shell over a UART.
+ *
+ * Received characters are collected in the shell's line buffer. A complete
+ * line is split into arguments in place, argv[] points into the line buffer,
+ * and the command is looked up in a perfect hash table generated at build
+ * time from a command list (scripts/cmdgen.py, pic_commands()): one hash,
+ * one displacement and one string compare, whatever the number of commands.
+ *
+ * Handlers are declared as int handler(int argc, char **argv) and print with
+ * shell_print*(), negative return values are reported as errors.
+ */
+
+#ifndef _SHELL_H_
+#define _SHELL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stdbool.h>
+#include <types.h>
+
+#define SHELL_LINE_MAX (128)
+#define SHELL_ARGS_MAX (8)
+
+/* returned by shell_exec() for an unknown command */
+#define SHELL_ENOENT (-2)
+/* returned by shell_exec() for more than SHELL_ARGS_MAX arguments */
+#define SHELL_E2BIG (-3)
+
+struct shell {
+	u8 nr;	/* number of the UART */
+	u32 len; /* characters in 'line' */
+	bool overflow; /* the current line is too long and is dropped */
+	char eol;	   /* character that ended the previous line */
+	char line[SHELL_LINE_MAX];
+};
+
+void shell_init(struct shell *sh, u8 nr);
+
+int shell_poll(struct shell *sh);
+
+int shell_exec(char *line);
+
+void shell_print(const char *str);
+
+void shell_printHex(u32 value);
+
+void shell_printDec(u32 value);
+
+bool shell_parseU32(const char *str, u32 *value);
+
+u32 shell_hash(const char *name, u32 seed);
+
+bool shell_streq(const char *a, const char *b);
+
+/* generated by scripts/cmdgen.py */
+
+int shell_lookup(const char *name);
+
+const char *shell_name(u32 slot, const char **help);
+
+int shell_call(u32 slot, int argc, char **argv);
+
+u32 shell_nr_slots(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SHELL_H_ */
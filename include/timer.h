@@ -0,0 +1,34 @@
+/**
+ * @file
+ *
+ * Declaration of public functions that handle
+ * the board's SP804 timer controllers.
+ */
+
+#ifndef _TIMER_H_
+#define _TIMER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <stdbool.h>
+#include <types.h>
+
+/* Each SP804 controller contains two independent counters */
+#define TIMER_NR_COUNTERS (2)
+
+void timer_init(u8 nr, u8 ctr);
+
+void timer_start(u8 nr, u8 ctr);
+
+void timer_stop(u8 nr, u8 ctr);
+
+bool timer_isEnabled(u8 nr, u8 ctr);
+
+u32 timer_getValue(u8 nr, u8 ctr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TIMER_H_ */
@@ -0,0 +1,24 @@
+/**
+ * @file
+ *
+ * Tuning knobs of the kernels, generated by scripts/autotune.py from
+ * scripts/tune.json, do not edit. Run "just tune" to measure the variants.
+ *
+ * These are the defaults of scripts/tune.json, no variant has been
+ * measured (--defaults).
+ *
+ * Builds may override single knobs with -D, see PIC_TUNE_DEFS.
+ */
+
+#ifndef _TUNE_H_
+#define _TUNE_H_
+
+/* scan, default, not measured */
+#ifndef SCAN_TARGET
+#define SCAN_TARGET "arm"
+#endif
+#ifndef SCAN_UNROLL
+#define SCAN_UNROLL 4
+#endif
+
+#endif /* _TUNE_H_ */
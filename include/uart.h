@@ -39,12 +39,18 @@ extern "C" {
 #endif
 #include <types.h>
 
+struct iovec;
+
 void uart_init(u8 nr);
 
 void uart_printChar(u8 nr, char ch);
 
 void uart_print(u8 nr, const char *str);
 
+void uart_write(u8 nr, const void *buf, u32 len);
+
+void uart_writev(u8 nr, const struct iovec *iov, u32 cnt);
+
 void uart_enableUart(u8 nr);
 
 void uart_disableUart(u8 nr);
@@ -57,6 +63,10 @@ void uart_enableRx(u8 nr);
 
 void uart_disableRx(u8 nr);
 
+void uart_enableLoopback(u8 nr);
+
+void uart_disableLoopback(u8 nr);
+
 void uart_enableRxInterrupt(u8 nr);
 
 void uart_disableRxInterrupt(u8 nr);
@@ -65,6 +75,8 @@ void uart_clearRxInterrupt(u8 nr);
 
 char uart_readChar(u8 nr);
 
+u32 uart_read(u8 nr, void *buf, u32 len);
+
 #ifdef __cplusplus
 }
 #endif
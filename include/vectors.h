@@ -0,0 +1,45 @@
+/**
+ * @file
+ *
+ * Interrupt handlers of the blob taken through its own high vector page,
+ * built when PIC_HIGH_VECTORS is defined (needs PIC_MMU).
+ *
+ * While an export runs with the blob's page table (mmu.h), a page of vectors
+ * is mapped at 0xFFFF0000 and the V bit of the control register is set in
+ * the same write that enables the MMU, mmu_leave() restores the host's
+ * setting with the rest of the register. The host's vector table at 0 is
+ * never written. The IRQ vector enters pic_irq() on an internal stack like
+ * any export, which calls the handlers installed for the pending lines:
+ *
+ *     vectors_install(VECTORS_SIC_IRQ(BSP_AACI_SIC_IRQ), aaci_isr);
+ *
+ * An IRQ of a line without handler, and every other exception, continues at
+ * the host's vector as if the V bit were clear. Handlers are kept in .bss,
+ * they are installed again after the blob has moved. Handlers called by
+ * pic_irq() must be listed in scripts/stack.annot.
+ */
+
+#ifndef _VECTORS_H_
+#define _VECTORS_H_
+
+#include <types.h>
+
+/* Lines 0-31 of the primary controller, then 0-31 of the SIC */
+#define VECTORS_NR_IRQS	   (64)
+#define VECTORS_SIC_IRQ(n) (32 + (n))
+
+/* pic_irq(): no pending line has a handler, the host takes the IRQ */
+#define VECTORS_EHOST (-1)
+
+/* Words of the vector page: 8 'ldr pc, [pc, #0x18]', then their targets */
+#define VECTORS_LDR_PC (0xE59FF018)
+#define VECTORS_IRQ	   (6)
+
+void vectors_install(u32 irq, void (*isr)(void));
+
+int pic_irq(void);
+
+/* IRQ entry of the vector page, in startup.S */
+void pic_irq_vector(void);
+
+#endif /* _VECTORS_H_ */
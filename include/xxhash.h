@@ -0,0 +1,23 @@
+/**
+ * @file
+ *
+ * xxHash32, a fast non-cryptographic hash of byte strings (Yann Collet's
+ * XXH32, same values as the reference). Input is read a word at a time,
+ * aligned input with word loads.
+ */
+
+#ifndef _XXHASH_H_
+#define _XXHASH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <types.h>
+
+u32 xxh32(const void *data, u32 len, u32 seed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _XXHASH_H_ */
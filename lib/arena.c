@@ -0,0 +1,53 @@
+/**
+ * @file
+ *
+ * Implementation of the bump allocator.
+ */
+
+#include <stddef.h>
+
+#include "arena.h"
+
+/**
+ * Initializes an empty arena over the memory area 'mem'.
+ *
+ * @param arena - arena to initialize
+ * @param mem - memory the allocations are carved from
+ * @param size - size of 'mem' in bytes
+ */
+void arena_init(struct arena *arena, void *mem, u32 size)
+{
+	arena->base = mem;
+	arena->size = size;
+	arena->used = 0;
+}
+
+/**
+ * Allocates 'size' bytes aligned to 'align' bytes.
+ *
+ * @param arena - arena to allocate from
+ * @param size - number of bytes
+ * @param align - alignment, a power of 2
+ *
+ * @return the allocated memory or NULL if the arena is exhausted
+ */
+void *arena_alloc(struct arena *arena, u32 size, u32 align)
+{
+	u32 start = ((u32)arena->base + arena->used + align - 1) & ~(align - 1);
+	u32 offset = start - (u32)arena->base;
+
+	if (offset > arena->size || size > arena->size - offset) {
+		return NULL;
+	}
+
+	arena->used = offset + size;
+
+	return (void *)start;
+}
+
+/**
+ * Releases all allocations of the arena.
+ *
+ * @param arena - arena
+ */
+void arena_reset(struct arena *arena) { arena->used = 0; }
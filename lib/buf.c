@@ -0,0 +1,201 @@
+/**
+ * @file
+ *
+ * Implementation of reference counted buffer chains.
+ */
+
+#include <stddef.h>
+
+#include "buf.h"
+
+/**
+ * Allocates a single buffer from a pool. BUF_HEADROOM bytes are reserved
+ * in front of the data, if the block is large enough.
+ *
+ * @param pool - pool to allocate from
+ *
+ * @return empty buffer with a reference count of 1, NULL if the pool is
+ * exhausted or its blocks have no room for data after the struct buf
+ */
+struct buf *buf_alloc(struct pool *pool)
+{
+	struct buf *buf;
+	u32 size;
+
+	if (pool->block_size <= sizeof(struct buf)) {
+		return NULL;
+	}
+
+	buf = pool_alloc(pool);
+	if (NULL == buf) {
+		return NULL;
+	}
+
+	size = pool->block_size - sizeof(struct buf);
+	buf->pool = pool;
+	buf->next = NULL;
+	buf->data = BUF_HEAD(buf) + (size > BUF_HEADROOM ? BUF_HEADROOM : 0);
+	buf->len = 0;
+	buf->end = BUF_HEAD(buf) + size;
+	buf->refcnt = 1;
+
+	return buf;
+}
+
+/**
+ * Drops a reference to every segment of the chain, segments that are no
+ * longer referenced are returned to their pool.
+ *
+ * Nothing is done if 'chain' is NULL.
+ *
+ * @param chain - first segment of the chain
+ */
+void buf_free(struct buf *chain)
+{
+	while (NULL != chain) {
+		struct buf *next = chain->next;
+
+		if (0 == --chain->refcnt) {
+			pool_free(chain->pool, chain);
+		}
+		chain = next;
+	}
+}
+
+/**
+ * Adds a reference to every segment of the chain.
+ *
+ * @param chain - first segment of the chain
+ *
+ * @return 'chain', for convenience
+ */
+struct buf *buf_ref(struct buf *chain)
+{
+	struct buf *seg;
+
+	for (seg = chain; NULL != seg; seg = seg->next) {
+		seg->refcnt++;
+	}
+
+	return chain;
+}
+
+/**
+ * Prepends 'len' bytes to the valid data, e.g. for a header.
+ *
+ * @param buf - buffer
+ * @param len - number of bytes to prepend
+ *
+ * @return start of the prepended bytes, NULL if the headroom is too small
+ */
+u8 *buf_push(struct buf *buf, u32 len)
+{
+	if (len > buf_headroom(buf)) {
+		return NULL;
+	}
+
+	buf->data -= len;
+	buf->len += len;
+
+	return buf->data;
+}
+
+/**
+ * Removes 'len' bytes from the start of the valid data, e.g. a parsed
+ * header.
+ *
+ * @param buf - buffer
+ * @param len - number of bytes to remove
+ *
+ * @return new start of the valid data, NULL if 'len' exceeds it
+ */
+u8 *buf_pull(struct buf *buf, u32 len)
+{
+	if (len > buf->len) {
+		return NULL;
+	}
+
+	buf->data += len;
+	buf->len -= len;
+
+	return buf->data;
+}
+
+/**
+ * Appends 'len' bytes to the valid data.
+ *
+ * @param buf - buffer
+ * @param len - number of bytes to append
+ *
+ * @return start of the appended bytes, NULL if the tailroom is too small
+ */
+u8 *buf_put(struct buf *buf, u32 len)
+{
+	u8 *tail = buf->data + buf->len;
+
+	if (len > buf_tailroom(buf)) {
+		return NULL;
+	}
+
+	buf->len += len;
+
+	return tail;
+}
+
+/**
+ * Links a segment (or another chain) to the end of the chain. The chain
+ * takes over the caller's reference to 'seg'.
+ *
+ * @param chain - first segment of the chain
+ * @param seg - segment to append
+ */
+void buf_append(struct buf *chain, struct buf *seg)
+{
+	while (NULL != chain->next) {
+		chain = chain->next;
+	}
+	chain->next = seg;
+}
+
+/**
+ * @param chain - first segment of the chain
+ *
+ * @return number of valid bytes in all segments of the chain
+ */
+u32 buf_chain_len(const struct buf *chain)
+{
+	u32 len = 0;
+
+	for (; NULL != chain; chain = chain->next) {
+		len += chain->len;
+	}
+
+	return len;
+}
+
+/**
+ * Describes the chain as a scatter/gather list, e.g. for uart_writev().
+ * Empty segments are skipped.
+ *
+ * @param chain - first segment of the chain
+ * @param iov - filled with one element per non-empty segment
+ * @param cnt - number of elements of 'iov'
+ *
+ * @return number of elements used, the chain is truncated if it has more
+ * than 'cnt' non-empty segments
+ */
+u32 buf_iov(const struct buf *chain, struct iovec *iov, u32 cnt)
+{
+	u32 n = 0;
+
+	for (; NULL != chain && n < cnt; chain = chain->next) {
+		if (0 == chain->len) {
+			continue;
+		}
+		iov[n].iov_base = chain->data;
+		iov[n].iov_len = chain->len;
+		n++;
+	}
+
+	return n;
+}
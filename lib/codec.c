@@ -0,0 +1,214 @@
+/**
+ * @file
+ *
+ * Implementation of the hex and base64 codecs. The lookup tables are built
+ * by the preprocessor, one entry per byte value.
+ */
+
+#include <stddef.h>
+
+#include "codec.h"
+
+#define __R4(f, b)	f(b), f(b + 1), f(b + 2), f(b + 3)
+#define __R16(f, b) __R4(f, b), __R4(f, b + 4), __R4(f, b + 8), __R4(f, b + 12)
+#define __R64(f, b)                                                            \
+	__R16(f, b), __R16(f, b + 16), __R16(f, b + 32), __R16(f, b + 48)
+#define __R256(f) __R64(f, 0), __R64(f, 64), __R64(f, 128), __R64(f, 192)
+
+#define __HEXDIGIT(n) ((n) < 10 ? '0' + (n) : 'a' - 10 + (n))
+/* both digits of a byte, the first one in the low half (little endian) */
+#define __HEX2(b) (__HEXDIGIT((b) >> 4) | __HEXDIGIT((b)&15) << 8)
+
+#define __HEXVAL(c)                                                            \
+	((c) >= '0' && (c) <= '9'	? (c) - '0'                                    \
+	 : (c) >= 'a' && (c) <= 'f' ? (c) - 'a' + 10                               \
+	 : (c) >= 'A' && (c) <= 'F' ? (c) - 'A' + 10                               \
+								: 0xff)
+
+#define __B64VAL(c)                                                            \
+	((c) >= 'A' && (c) <= 'Z'	? (c) - 'A'                                    \
+	 : (c) >= 'a' && (c) <= 'z' ? (c) - 'a' + 26                               \
+	 : (c) >= '0' && (c) <= '9' ? (c) - '0' + 52                               \
+	 : (c) == '+'				? 62                                           \
+	 : (c) == '/'				? 63                                           \
+								: 0xff)
+
+static const u16 hex_digits[256] = {__R256(__HEX2)};
+static const u8 hex_values[256] = {__R256(__HEXVAL)};
+
+static const char base64_digits[64] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const u8 base64_values[256] = {__R256(__B64VAL)};
+
+/**
+ * @param dst - HEX_LEN(len) characters, not '\0' terminated
+ * @param src - bytes to encode
+ * @param len - number of bytes of 'src'
+ *
+ * @return number of characters written
+ */
+u32 hex_encode(char *dst, const void *src, u32 len)
+{
+	const u8 *s = src;
+	const u8 *end = s + len;
+	u16 digits;
+
+	if (0 == ((size_t)dst & 1)) {
+		/* aligned destination: a halfword per byte, a word of source at once */
+		u16 *d = (u16 *)dst;
+		const u32 *w;
+
+		for (; s < end && 0 != ((size_t)s & 3); s++) {
+			*d++ = hex_digits[*s];
+		}
+		for (w = (const u32 *)s; (u32)(end - (const u8 *)w) >= 4; w++, d += 4) {
+			u32 v = *w;
+
+			d[0] = hex_digits[v & 0xff];
+			d[1] = hex_digits[(v >> 8) & 0xff];
+			d[2] = hex_digits[(v >> 16) & 0xff];
+			d[3] = hex_digits[v >> 24];
+		}
+		for (s = (const u8 *)w; s < end; s++) {
+			*d++ = hex_digits[*s];
+		}
+	} else {
+		char *d = dst;
+
+		for (; s < end; s++) {
+			digits = hex_digits[*s];
+			*d++ = (char)digits;
+			*d++ = (char)(digits >> 8);
+		}
+	}
+
+	return HEX_LEN(len);
+}
+
+/**
+ * Either case is accepted.
+ *
+ * @param dst - len / 2 bytes
+ * @param src - hex digits
+ * @param len - number of characters of 'src'
+ *
+ * @return number of bytes written, less than len / 2 if 'src' holds a
+ * character that is not a hex digit
+ */
+u32 hex_decode(void *dst, const char *src, u32 len)
+{
+	const u8 *s = (const u8 *)src;
+	u8 *d = dst;
+	u32 i;
+
+	for (i = 0; i < len / 2; i++, s += 2) {
+		u32 hi = hex_values[s[0]];
+		u32 lo = hex_values[s[1]];
+
+		if (0 != ((hi | lo) & 0xf0)) {
+			break;
+		}
+		d[i] = (u8)(hi << 4 | lo);
+	}
+
+	return i;
+}
+
+/* four digits of three bytes, the first one in the low byte */
+static inline u32 __base64Group(u32 a, u32 b, u32 c)
+{
+	u32 v = a << 16 | b << 8 | c;
+
+	return (u32)(u8)base64_digits[v >> 18] |
+		   (u32)(u8)base64_digits[(v >> 12) & 63] << 8 |
+		   (u32)(u8)base64_digits[(v >> 6) & 63] << 16 |
+		   (u32)(u8)base64_digits[v & 63] << 24;
+}
+
+/**
+ * Standard alphabet, padded with '='.
+ *
+ * @param dst - BASE64_LEN(len) characters, not '\0' terminated
+ * @param src - bytes to encode
+ * @param len - number of bytes of 'src'
+ *
+ * @return number of characters written
+ */
+u32 base64_encode(char *dst, const void *src, u32 len)
+{
+	const u8 *s = src;
+	const u8 *end = s + len / 3 * 3;
+	char *d = dst;
+	u32 group;
+
+	if (0 == ((size_t)d & 3)) {
+		/* aligned destination: a word per group */
+		for (; s < end; s += 3, d += 4) {
+			*(u32 *)d = __base64Group(s[0], s[1], s[2]);
+		}
+	} else {
+		for (; s < end; s += 3, d += 4) {
+			group = __base64Group(s[0], s[1], s[2]);
+			d[0] = (char)group;
+			d[1] = (char)(group >> 8);
+			d[2] = (char)(group >> 16);
+			d[3] = (char)(group >> 24);
+		}
+	}
+
+	if (len % 3 != 0) {
+		group = __base64Group(s[0], (len % 3 == 2 ? s[1] : 0), 0);
+		d[0] = (char)group;
+		d[1] = (char)(group >> 8);
+		d[2] = (len % 3 == 2 ? (char)(group >> 16) : '=');
+		d[3] = '=';
+	}
+
+	return BASE64_LEN(len);
+}
+
+/**
+ * Standard alphabet, the last group may be padded with '='.
+ *
+ * @param dst - len / 4 * 3 bytes
+ * @param src - base64 digits
+ * @param len - number of characters of 'src', a multiple of 4
+ *
+ * @return number of bytes written, decoding stops at the first character
+ * that is not a digit or misplaced padding
+ */
+u32 base64_decode(void *dst, const char *src, u32 len)
+{
+	const u8 *s = (const u8 *)src;
+	u8 *d = dst;
+	u32 i, v;
+
+	for (i = 0; i + 4 <= len; i += 4, s += 4) {
+		u32 a = base64_values[s[0]];
+		u32 b = base64_values[s[1]];
+		u32 c = base64_values[s[2]];
+		u32 e = base64_values[s[3]];
+
+		if (0 == ((a | b | c | e) & 0xc0)) {
+			v = a << 18 | b << 12 | c << 6 | e;
+			*d++ = (u8)(v >> 16);
+			*d++ = (u8)(v >> 8);
+			*d++ = (u8)v;
+			continue;
+		}
+
+		/* only the last group may be padded: "xx==" or "xxx=" */
+		if (i + 4 != len || 0 != ((a | b) & 0xc0) || '=' != s[3] ||
+			('=' != s[2] && 0 != (c & 0xc0))) {
+			break;
+		}
+		v = a << 18 | b << 12;
+		*d++ = (u8)(v >> 16);
+		if ('=' != s[2]) {
+			v |= c << 6;
+			*d++ = (u8)(v >> 8);
+		}
+	}
+
+	return d - (u8 *)dst;
+}
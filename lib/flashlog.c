@@ -0,0 +1,398 @@
+/**
+ * @file
+ *
+ * Implementation of the log-structured flash store, see flashlog.h.
+ *
+ * A sector starts with a 16 byte header: FLASHLOG_MAGIC, its sequence
+ * number, the sequence number of the oldest sector of the log and a check
+ * word. Records follow, 4 byte aligned: a word holding the length (bits
+ * 0-15), the type (16-23) and a check of both (24-31), the checksum of the
+ * data, then the data padded with erased bytes. A record never straddles
+ * sectors, the rest of a sector a record does not fit in stays erased.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "flashlog.h"
+
+/* "FLOG" */
+#define FLASHLOG_MAGIC (0x474F4C46)
+
+#define SECTOR_HEADER (16)
+
+/* What flashlog_poll() does next */
+#define STEP_ERASE	(0) /* erase the current sector */
+#define STEP_HEADER (1) /* program the current sector's header */
+#define STEP_DATA	(2) /* program the staged records */
+
+/* first word of a record header */
+static u32 __recWord(u32 len, u8 type)
+{
+	return len | (u32)type << 16 | (u32)(~(len ^ len >> 8 ^ type) & 0xFF) << 24;
+}
+
+static bool __recValid(u32 w) { return w == __recWord(w & 0xFFFF, w >> 16); }
+
+/* Fletcher style checksum of the record data, continued from 'sum' */
+static u32 __checksum(u32 sum, const u8 *p, u32 len)
+{
+	u32 a = sum & 0xFFFF;
+	u32 b = sum >> 16;
+	u32 i;
+
+	for (i = 0; i < len; i++) {
+		a = (a + p[i]) & 0xFFFF;
+		b = (b + a) & 0xFFFF;
+	}
+
+	return b << 16 | a;
+}
+
+static u32 __sector(const struct flashlog *log, u32 idx)
+{
+	return log->first + idx * log->flash->sector_size;
+}
+
+/* true if 'hdr' is a valid sector header */
+static bool __sectorValid(const u32 *hdr)
+{
+	return FLASHLOG_MAGIC == hdr[0] &&
+		   hdr[3] == ~(FLASHLOG_MAGIC ^ hdr[1] ^ hdr[2]);
+}
+
+/* moves on to the next sector, which is erased first */
+static void __nextSector(struct flashlog *log, bool format)
+{
+	u32 oldest;
+
+	log->cur = (log->cur + 1) % log->nr_sectors;
+	log->seq++;
+	oldest = log->seq - log->nr_sectors + 1;
+	if (format || (s32)(log->base - oldest) < 0) {
+		log->base = (format ? log->seq : oldest);
+	}
+
+	log->hdr[0] = FLASHLOG_MAGIC;
+	log->hdr[1] = log->seq;
+	log->hdr[2] = log->base;
+	log->hdr[3] = ~(FLASHLOG_MAGIC ^ log->seq ^ log->base);
+	log->hdr_done = 0;
+	log->step = STEP_ERASE;
+}
+
+static void __ringPut(struct flashlog *log, const void *src, u32 len)
+{
+	const u8 *p = src;
+	u32 i;
+
+	for (i = 0; i < len; i++, log->head++) {
+		log->ring[log->head & log->mask] = (NULL != p ? p[i] : 0xFF);
+	}
+}
+
+/**
+ * @param log - log to initialize, flashlog_mount() must follow
+ * @param flash - probed flash
+ * @param first - offset of the first sector of the log
+ * @param nr_sectors - number of sectors, at least 2
+ * @param ring - RAM the records are staged in
+ * @param ring_size - its size, a power of 2 of at least
+ *                    FLASHLOG_REC_SIZE(FLASHLOG_REC_MAX)
+ *
+ * @return 0, or FLASHLOG_EINVAL if the sectors or the ring are unsuitable
+ */
+int flashlog_init(struct flashlog *log, struct cfi_flash *flash, u32 first,
+				  u32 nr_sectors, void *ring, u32 ring_size)
+{
+	u32 sector = flash->sector_size;
+
+	if (0 != (first & (sector - 1)) || nr_sectors < 2 ||
+		nr_sectors > (flash->size - first) / sector ||
+		sector < SECTOR_HEADER + FLASHLOG_REC_SIZE(FLASHLOG_REC_MAX) ||
+		0 != (ring_size & (ring_size - 1)) ||
+		ring_size < FLASHLOG_REC_SIZE(FLASHLOG_REC_MAX)) {
+		return FLASHLOG_EINVAL;
+	}
+
+	log->flash = flash;
+	log->first = first;
+	log->nr_sectors = nr_sectors;
+	log->ring = ring;
+	log->mask = ring_size - 1;
+	log->head = 0;
+	log->tail = 0;
+	log->rec_left = 0;
+	log->pending = STEP_DATA;
+	log->records = 0;
+	log->dropped = 0;
+	log->errors = 0;
+
+	return 0;
+}
+
+/**
+ * Finds the newest sector and the end of its records, reading the flash
+ * directly. A blank range starts a new log in its first sector. Records
+ * staged before are discarded.
+ *
+ * @param log - initialized log
+ *
+ * @return 0, or CFI_BUSY if a flash operation is in progress
+ */
+int flashlog_mount(struct flashlog *log)
+{
+	u32 sector_size = log->flash->sector_size;
+	u32 hdr[4], rec[2];
+	bool found = false;
+	u32 i, off;
+
+	for (i = 0; i < log->nr_sectors; i++) {
+		if (0 != cfi_flash_read(log->flash, __sector(log, i), hdr, sizeof(hdr))) {
+			return CFI_BUSY;
+		}
+		if (__sectorValid(hdr) && (!found || (s32)(hdr[1] - log->seq) > 0)) {
+			log->cur = i;
+			log->seq = hdr[1];
+			log->base = hdr[2];
+			found = true;
+		}
+	}
+
+	log->head = 0;
+	log->tail = 0;
+	log->rec_left = 0;
+	if (!found) {
+		log->cur = log->nr_sectors - 1;
+		log->seq = 0;
+		__nextSector(log, true);
+		return 0;
+	}
+	if ((s32)(log->base - (log->seq - log->nr_sectors + 1)) < 0) {
+		log->base = log->seq - log->nr_sectors + 1;
+	}
+
+	for (off = SECTOR_HEADER; off + sizeof(rec) <= sector_size;
+		 off += FLASHLOG_REC_SIZE(rec[0] & 0xFFFF)) {
+		cfi_flash_read(log->flash, __sector(log, log->cur) + off, rec, sizeof(rec));
+		if (0xFFFFFFFF == rec[0] && 0xFFFFFFFF == rec[1]) {
+			break;
+		}
+		if (!__recValid(rec[0]) ||
+			off + FLASHLOG_REC_SIZE(rec[0] & 0xFFFF) > sector_size) {
+			/* a torn header, nothing can be appended behind it */
+			__nextSector(log, false);
+			return 0;
+		}
+	}
+
+	log->prog = __sector(log, log->cur) + off;
+	log->step = STEP_DATA;
+
+	return 0;
+}
+
+/**
+ * Starts a new, empty log in the next sector, e.g. before staging a blob
+ * image. The remainder of a record being programmed is dropped, the other
+ * staged records are written to the new log.
+ *
+ * @param log - mounted log
+ */
+void flashlog_format(struct flashlog *log)
+{
+	log->tail += log->rec_left;
+	log->rec_left = 0;
+	__nextSector(log, true);
+}
+
+/**
+ * Stages a record, it is written by later calls of flashlog_poll(). Must
+ * not be called concurrently with flashlog_poll().
+ *
+ * @param log - mounted log
+ * @param type - type of the record, for the readers
+ * @param data - record data
+ * @param len - number of bytes, at most FLASHLOG_REC_MAX
+ *
+ * @return 0, FLASHLOG_EFULL if the ring has no room (the record is dropped
+ * and counted), or FLASHLOG_EINVAL
+ */
+int flashlog_append(struct flashlog *log, u8 type, const void *data, u32 len)
+{
+	u32 size = FLASHLOG_REC_SIZE(len);
+	u32 rec[2];
+
+	if (len > FLASHLOG_REC_MAX) {
+		return FLASHLOG_EINVAL;
+	}
+	if (log->mask + 1 - (log->head - log->tail) < size) {
+		log->dropped++;
+		return FLASHLOG_EFULL;
+	}
+
+	rec[0] = __recWord(len, type);
+	rec[1] = __checksum(0, data, len);
+	__ringPut(log, rec, sizeof(rec));
+	__ringPut(log, data, len);
+	__ringPut(log, NULL, size - sizeof(rec) - len);
+	log->records++;
+
+	return 0;
+}
+
+/**
+ * Completes the flash operation in progress, if it is done, and starts the
+ * next one. Failed operations are counted. A sector whose erase or header
+ * failed is given up for the next one, which the readers skip as invalid. A
+ * record hit by a failed program is skipped by the readers.
+ *
+ * @param log - mounted log
+ *
+ * @return FLASHLOG_BUSY while an operation is in progress or records are
+ * staged, 0 when everything has been written
+ */
+int flashlog_poll(struct flashlog *log)
+{
+	struct cfi_flash *f = log->flash;
+	u32 sector = __sector(log, log->cur);
+	u32 pos, len;
+	int r;
+
+	r = cfi_flash_poll(f);
+	if (CFI_BUSY == r) {
+		return FLASHLOG_BUSY;
+	}
+	if (r < 0) {
+		log->errors++;
+		if (STEP_DATA != log->pending) {
+			log->pending = STEP_DATA;
+			__nextSector(log, false);
+			return FLASHLOG_BUSY;
+		}
+	}
+
+	switch (log->step) {
+	case STEP_ERASE:
+		if (cfi_flash_eraseStart(f, sector) >= 0) {
+			log->pending = STEP_ERASE;
+			log->step = STEP_HEADER;
+		}
+		return FLASHLOG_BUSY;
+	case STEP_HEADER:
+		r = cfi_flash_programStart(f, sector + log->hdr_done,
+								   (const u8 *)log->hdr + log->hdr_done,
+								   SECTOR_HEADER - log->hdr_done);
+		if (r > 0) {
+			log->pending = STEP_HEADER;
+			log->hdr_done += r;
+		}
+		if (SECTOR_HEADER == log->hdr_done) {
+			log->prog = sector + SECTOR_HEADER;
+			log->step = STEP_DATA;
+		}
+		return FLASHLOG_BUSY;
+	default:
+		break;
+	}
+
+	if (log->head == log->tail) {
+		return 0;
+	}
+
+	if (0 == log->rec_left) {
+		pos = log->tail & log->mask;
+		len = log->ring[pos] | log->ring[(pos + 1) & log->mask] << 8;
+		if (log->prog - sector + FLASHLOG_REC_SIZE(len) > f->sector_size) {
+			__nextSector(log, false);
+			return FLASHLOG_BUSY;
+		}
+		log->rec_left = FLASHLOG_REC_SIZE(len);
+	}
+
+	/* the contiguous part of the record in the ring */
+	pos = log->tail & log->mask;
+	len = log->mask + 1 - pos;
+	len = (len < log->rec_left ? len : log->rec_left);
+	r = cfi_flash_programStart(f, log->prog, &log->ring[pos], len);
+	if (r > 0) {
+		log->pending = STEP_DATA;
+		log->tail += r;
+		log->prog += r;
+		log->rec_left -= r;
+	}
+
+	return FLASHLOG_BUSY;
+}
+
+/**
+ * @param log - mounted log
+ * @param c - cursor set to the oldest record of the log
+ */
+void flashlog_rewind(const struct flashlog *log, struct flashlog_cursor *c)
+{
+	u32 oldest = log->seq - log->nr_sectors + 1;
+
+	c->seq = ((s32)(log->base - oldest) > 0 ? log->base : oldest);
+	c->off = SECTOR_HEADER;
+}
+
+/**
+ * Reads the record at the cursor and advances it. Only records already
+ * programmed are found, and only while no flash operation is in progress
+ * (flashlog_poll() returned 0). Records failing their checksum are skipped.
+ *
+ * @param log - mounted log
+ * @param c - cursor, see flashlog_rewind()
+ * @param type - receives the type of the record
+ * @param buf - receives the first 'max' bytes of the data
+ * @param max - size of 'buf'
+ *
+ * @return length of the record's data, FLASHLOG_END, or CFI_BUSY
+ */
+int flashlog_next(const struct flashlog *log, struct flashlog_cursor *c,
+				  u8 *type, void *buf, u32 max)
+{
+	u32 sector_size = log->flash->sector_size;
+	u8 chunk[64];
+	u32 hdr[4], rec[2];
+	u32 sector, limit, len, done, k, i, sum;
+
+	for (; (s32)(c->seq - log->seq) <= 0; c->seq++, c->off = SECTOR_HEADER) {
+		sector = __sector(log, (log->cur + log->nr_sectors - (log->seq - c->seq)) %
+								   log->nr_sectors);
+		if (0 != cfi_flash_read(log->flash, sector, hdr, sizeof(hdr))) {
+			return CFI_BUSY;
+		}
+		if (!__sectorValid(hdr) || hdr[1] != c->seq) {
+			/* not written yet, or being erased */
+			continue;
+		}
+		limit = (c->seq == log->seq ? log->prog - sector : sector_size);
+
+		while (c->off + sizeof(rec) <= limit) {
+			cfi_flash_read(log->flash, sector + c->off, rec, sizeof(rec));
+			len = rec[0] & 0xFFFF;
+			if (!__recValid(rec[0]) || c->off + FLASHLOG_REC_SIZE(len) > limit) {
+				break;
+			}
+
+			sum = 0;
+			for (done = 0; done < len; done += k) {
+				k = (len - done < sizeof(chunk) ? len - done : sizeof(chunk));
+				cfi_flash_read(log->flash, sector + c->off + 8 + done, chunk, k);
+				sum = __checksum(sum, chunk, k);
+				for (i = 0; i < k && done + i < max; i++) {
+					((u8 *)buf)[done + i] = chunk[i];
+				}
+			}
+			c->off += FLASHLOG_REC_SIZE(len);
+			if (sum == rec[1]) {
+				*type = (u8)(rec[0] >> 16);
+				return len;
+			}
+		}
+	}
+
+	return FLASHLOG_END;
+}
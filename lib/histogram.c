@@ -0,0 +1,74 @@
+/**
+ * @file
+ *
+ * Log-linear latency histograms, see histogram.h. Recording is inline, this
+ * is what reads them on the target.
+ */
+
+#include "histogram.h"
+
+/**
+ * Clears the counters, the name is kept.
+ *
+ * @param h - histogram
+ */
+void histogram_reset(struct histogram *h)
+{
+	u32 i;
+
+	h->count = 0;
+	h->max = 0;
+	for (i = 0; i < HIST_BUCKETS; i++) {
+		h->buckets[i] = 0;
+	}
+}
+
+/**
+ * @param index - bucket, below HIST_BUCKETS
+ *
+ * @return smallest value of the bucket
+ */
+u32 histogram_bucketLow(u32 index)
+{
+	u32 shift;
+
+	if (index < HIST_SUB) {
+		return index;
+	}
+	shift = (index >> HIST_SUB_BITS) - 1;
+
+	return (HIST_SUB + (index & (HIST_SUB - 1))) << shift;
+}
+
+/**
+ * @param h - histogram
+ * @param permille - percentile in 1/1000, e.g. 999 for p99.9
+ *
+ * @return largest value of the bucket holding the percentile, at most the
+ * largest value recorded; 0 if the histogram is empty
+ */
+u32 histogram_percentile(const struct histogram *h, u32 permille)
+{
+	/* rank of the value, count * permille / 1000 rounded up without overflow */
+	u32 rank = h->count / 1000 * permille + (h->count % 1000 * permille + 999) / 1000;
+	u32 seen = 0;
+	u32 i;
+
+	if (0 == h->count) {
+		return 0;
+	}
+	if (0 == rank) {
+		rank = 1;
+	}
+	for (i = 0; i < HIST_BUCKETS - 1; i++) {
+		seen += h->buckets[i];
+		if (seen >= rank) {
+			break;
+		}
+	}
+	if (i == HIST_BUCKETS - 1 || histogram_bucketLow(i + 1) - 1 > h->max) {
+		return h->max;
+	}
+
+	return histogram_bucketLow(i + 1) - 1;
+}
@@ -0,0 +1,401 @@
+/**
+ * @file
+ *
+ * Implementation of the runtime code specializer: a minimal ARM (A32)
+ * instruction emitter, the kernel templates and the variant cache.
+ *
+ * Instruction encodings are taken from the ARM Architecture Reference
+ * Manual (DDI0100I), all instructions are emitted with the AL condition.
+ * Generated kernels are leaf functions that use r0-r3 only.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "jit.h"
+#include "cache.h"
+
+enum jit_kind {
+	JIT_FIR = 1,
+	JIT_COPY,
+	JIT_MATCH,
+};
+
+/* Registers */
+#define R0 (0)
+#define R1 (1)
+#define R2 (2)
+#define R3 (3)
+
+/* Data processing opcodes, immediate operand form */
+#define OP_MOV_IMM (0xE3A00000)
+#define OP_ORR_IMM (0xE3800000)
+#define OP_ADD_IMM (0xE2800000)
+#define OP_CMP_IMM (0xE3500000)
+/* Data processing opcodes, register operand shifted left */
+#define OP_ADD_LSL (0xE0800000)
+#define OP_SUB_LSL (0xE0400000)
+#define OP_MOV_REG (0xE1A00000)
+/* Multiplies */
+#define OP_MUL	   (0xE0000090)
+#define OP_MLA	   (0xE0200090)
+/* Loads and stores */
+#define OP_LDRSH   (0xE1D000F0) /* [rn, #imm8] */
+#define OP_LDRB	   (0xE5D00000) /* [rn, #imm12] */
+#define OP_LDR_POST (0xE4900000) /* [rn], #imm12 */
+#define OP_STR_POST (0xE4800000) /* [rn], #imm12 */
+/* Branches */
+#define OP_BNE	   (0x1A000000)
+#define OP_BX_LR   (0xE12FFF1E)
+
+/* Largest offset of a halfword load */
+#define LDRSH_MAX_OFFSET (255)
+/* Largest offset of a word or byte load */
+#define LDR_MAX_OFFSET	 (4095)
+
+struct emitter {
+	u32 *start;
+	u32 *pos;
+	u32 *end;
+	bool overflow;
+};
+
+static inline void emit(struct emitter *e, u32 insn)
+{
+	if (e->pos < e->end) {
+		*e->pos++ = insn;
+	} else {
+		e->overflow = true;
+	}
+}
+
+/*
+ * Emits 'rd' = 'value' as a MOV followed by one ORR per further 8-bit
+ * chunk (at most 4 instructions), instead of a literal pool load.
+ */
+static void emit_const(struct emitter *e, u32 rd, u32 value)
+{
+	u32 op = OP_MOV_IMM | (rd << 12);
+
+	if (0 == value) {
+		emit(e, op);
+		return;
+	}
+
+	while (0 != value) {
+		/* lowest set bit, rounded down to an even rotation */
+		u32 shift = __builtin_ctz(value) & ~1;
+		u32 chunk = (value >> shift) & 0xFF;
+		u32 rot = ((32 - shift) / 2) & 0xF;
+
+		emit(e, op | (rot << 8) | chunk);
+		value &= ~(0xFF << shift);
+		op = OP_ORR_IMM | (rd << 16) | (rd << 12);
+	}
+}
+
+/* rd = rn + imm, 'imm' below 256 */
+static inline void emit_add_imm(struct emitter *e, u32 rd, u32 rn, u32 imm)
+{
+	emit(e, OP_ADD_IMM | (rn << 16) | (rd << 12) | imm);
+}
+
+/* ldrsh rd, [rn, #imm], 'imm' up to LDRSH_MAX_OFFSET */
+static inline void emit_ldrsh(struct emitter *e, u32 rd, u32 rn, u32 imm)
+{
+	emit(e, OP_LDRSH | (rn << 16) | (rd << 12) | ((imm >> 4) << 8) |
+				(imm & 0xF));
+}
+
+/*
+ * FIR template: r0 points to the samples, r1 is the accumulator, r2 the
+ * sample and r3 the coefficient. Zero taps are dropped, taps of +-2^k
+ * become a shifted add or subtract, others a multiply.
+ */
+static void emit_fir(struct emitter *e, const void *key, u32 len)
+{
+	const s16 *taps = key;
+	u32 ntaps = len / sizeof(s16);
+	u32 base = 0; /* bytes r0 has been advanced by */
+	u32 i;
+
+	emit_const(e, R1, 0);
+	for (i = 0; i < ntaps; i++) {
+		s32 coef = taps[i];
+		u32 mag = (coef < 0 ? -coef : coef);
+		u32 op = (coef < 0 ? OP_SUB_LSL : OP_ADD_LSL);
+		u32 off;
+
+		if (0 == coef) {
+			continue;
+		}
+
+		while (2 * i - base > LDRSH_MAX_OFFSET - 1) {
+			emit_add_imm(e, R0, R0, LDRSH_MAX_OFFSET - 1);
+			base += LDRSH_MAX_OFFSET - 1;
+		}
+		off = 2 * i - base;
+		emit_ldrsh(e, R2, R0, off);
+
+		if (0 == (mag & (mag - 1))) {
+			/* acc +-= x << k */
+			emit(e, op | (R1 << 16) | (R1 << 12) |
+						((__builtin_ctz(mag)) << 7) | R2);
+		} else if (coef > 0) {
+			emit_const(e, R3, mag);
+			emit(e, OP_MLA | (R1 << 16) | (R1 << 12) | (R3 << 8) | R2);
+		} else {
+			emit_const(e, R3, mag);
+			emit(e, OP_MUL | (R3 << 16) | (R3 << 8) | R2);
+			emit(e, OP_SUB_LSL | (R1 << 16) | (R1 << 12) | R3);
+		}
+	}
+	emit(e, OP_MOV_REG | (R0 << 12) | R1);
+	emit(e, OP_BX_LR);
+}
+
+/*
+ * Strided copy template: one post-indexed load and store per word. The key
+ * is { count, dst_stride, src_stride }, strides in bytes.
+ */
+static void emit_copy(struct emitter *e, const void *key, u32 len)
+{
+	const u32 *param = key;
+	u32 count;
+
+	(void)len;
+	for (count = param[0]; count > 0; --count) {
+		emit(e, OP_LDR_POST | (R1 << 16) | (R2 << 12) | param[2]);
+		emit(e, OP_STR_POST | (R0 << 16) | (R2 << 12) | param[1]);
+	}
+	emit(e, OP_BX_LR);
+}
+
+/* Pattern template: compare each byte against an immediate */
+static void emit_match(struct emitter *e, const void *key, u32 len)
+{
+	const u8 *pattern = key;
+	u32 *fail;
+	u32 i;
+
+	/* branches are emitted first and patched once the exit is known */
+	for (i = 0; i < len; i++) {
+		emit(e, OP_LDRB | (R0 << 16) | (R1 << 12) | i);
+		emit(e, OP_CMP_IMM | (R1 << 16) | pattern[i]);
+		emit(e, OP_BNE);
+	}
+	emit(e, OP_MOV_IMM | (R0 << 12) | 1);
+	emit(e, OP_BX_LR);
+	fail = e->pos;
+	emit(e, OP_MOV_IMM | (R0 << 12) | 0);
+	emit(e, OP_BX_LR);
+
+	if (e->overflow) {
+		return;
+	}
+	for (i = 0; i < len; i++) {
+		u32 *bne = e->start + 3 * i + 2;
+
+		/* offset is relative to the branch + 8 bytes, in words */
+		*bne |= ((u32)(fail - bne - 2)) & 0x00FFFFFF;
+	}
+}
+
+/* FNV-1a over the kind and the key */
+static u32 jit_hash(u32 kind, const u8 *param, u32 len)
+{
+	u32 hash = 2166136261u ^ kind;
+
+	for (; len > 0; --len, ++param) {
+		hash = (hash ^ *param) * 16777619u;
+	}
+
+	return hash;
+}
+
+static bool jit_equal(const u8 *a, const u8 *b, u32 len)
+{
+	for (; len > 0; --len) {
+		if (*a++ != *b++) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static struct jit_entry *jit_lookup(struct jit_cache *cache, u32 kind,
+									u32 hash, const void *param, u32 len)
+{
+	u32 i;
+
+	for (i = 0; i < cache->nr_entries; i++) {
+		struct jit_entry *ent = &cache->entries[i];
+
+		if (ent->hash == hash && ent->kind == kind && ent->len == len &&
+			jit_equal(ent->param, param, len)) {
+			return ent;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Copies the key into the arena and starts an emitter over the rest of
+ * it. Returns false if the arena is too small.
+ */
+static bool jit_begin(struct jit_cache *cache, struct emitter *e,
+					  const void *param, u32 len, u8 **copy)
+{
+	struct arena *arena = cache->arena;
+	const u8 *src = param;
+	u32 i;
+
+	*copy = arena_alloc(arena, len, 4);
+	if (NULL == *copy) {
+		return false;
+	}
+	for (i = 0; i < len; i++) {
+		(*copy)[i] = src[i];
+	}
+
+	e->start = arena_alloc(arena, 0, CACHE_LINE_SIZE);
+	if (NULL == e->start) {
+		return false;
+	}
+	e->pos = e->start;
+	e->end = (u32 *)(arena->base + arena->size);
+	e->overflow = false;
+
+	return true;
+}
+
+/*
+ * Looks up the variant described by 'key', generating it by 'gen' on a
+ * miss. The key holds all parameters of the kernel. The cache is flushed and
+ * generation retried once if the arena or the table is full.
+ */
+static void *jit_get(struct jit_cache *cache, u32 kind, const void *param,
+					 u32 len, void (*gen)(struct emitter *, const void *, u32))
+{
+	u32 hash = jit_hash(kind, param, len);
+	struct jit_entry *ent = jit_lookup(cache, kind, hash, param, len);
+	struct emitter e;
+	u8 *copy;
+	int retry;
+
+	if (NULL != ent) {
+		cache->hits++;
+		return ent->fn;
+	}
+	cache->misses++;
+
+	for (retry = 0; retry < 2; retry++) {
+		if (cache->nr_entries < JIT_CACHE_SIZE &&
+			jit_begin(cache, &e, param, len, &copy)) {
+			gen(&e, param, len);
+			if (!e.overflow) {
+				/* commit the code to the arena */
+				cache->arena->used = (u8 *)e.pos - cache->arena->base;
+				cache_sync_icache(e.start, (u8 *)e.pos - (u8 *)e.start);
+
+				ent = &cache->entries[cache->nr_entries++];
+				ent->kind = kind;
+				ent->hash = hash;
+				ent->len = len;
+				ent->param = copy;
+				ent->fn = e.start;
+				return ent->fn;
+			}
+		}
+		jit_flush(cache);
+	}
+
+	/* does not fit even into an empty arena */
+	return NULL;
+}
+
+/**
+ * Initializes an empty variant cache. Code is generated into 'arena', which
+ * must be executable memory owned by the cache.
+ *
+ * @param cache - cache to initialize
+ * @param arena - arena the parameters and the code are stored in
+ */
+void jit_init(struct jit_cache *cache, struct arena *arena)
+{
+	cache->arena = arena;
+	cache->nr_entries = 0;
+	cache->hits = 0;
+	cache->misses = 0;
+	arena_reset(arena);
+}
+
+/**
+ * Drops all variants. Code returned before must not be called any more.
+ *
+ * @param cache - cache
+ */
+void jit_flush(struct jit_cache *cache)
+{
+	cache->nr_entries = 0;
+	arena_reset(cache->arena);
+}
+
+/**
+ * Returns a FIR kernel with the taps folded into the code.
+ *
+ * @param cache - variant cache
+ * @param taps - coefficients
+ * @param ntaps - number of coefficients
+ *
+ * @return the kernel or NULL if it does not fit into the arena
+ */
+jit_fir_fn jit_fir(struct jit_cache *cache, const s16 *taps, u32 ntaps)
+{
+	return (jit_fir_fn)jit_get(cache, JIT_FIR, taps, ntaps * sizeof(s16),
+							   emit_fir);
+}
+
+/**
+ * Returns a copy kernel for 'count' words with fixed strides.
+ *
+ * @param cache - variant cache
+ * @param count - number of words to copy
+ * @param dst_stride - distance between destination words, in bytes
+ * @param src_stride - distance between source words, in bytes
+ *
+ * @return the kernel or NULL if it does not fit into the arena or a stride
+ * exceeds 4095 bytes
+ */
+jit_copy_fn jit_copy(struct jit_cache *cache, u32 count, u32 dst_stride,
+					 u32 src_stride)
+{
+	u32 key[3] = {count, dst_stride, src_stride};
+
+	if (dst_stride > LDR_MAX_OFFSET || src_stride > LDR_MAX_OFFSET) {
+		return NULL;
+	}
+
+	return (jit_copy_fn)jit_get(cache, JIT_COPY, key, sizeof(key), emit_copy);
+}
+
+/**
+ * Returns a kernel testing for a fixed byte pattern.
+ *
+ * @param cache - variant cache
+ * @param pattern - bytes to match
+ * @param len - length of the pattern, at most 4096 bytes
+ *
+ * @return the kernel or NULL if it does not fit into the arena or the
+ * pattern is too long
+ */
+jit_match_fn jit_match(struct jit_cache *cache, const u8 *pattern, u32 len)
+{
+	if (len > LDR_MAX_OFFSET + 1) {
+		return NULL;
+	}
+
+	return (jit_match_fn)jit_get(cache, JIT_MATCH, pattern, len, emit_match);
+}
@@ -0,0 +1,317 @@
+/**
+ * @file
+ *
+ * Memoization of pure functions, see memo.h.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "memo.h"
+#include "image.h"
+#include "import.h"
+#include "xxhash.h"
+
+/* "MEMO" */
+#define MEMO_MAGIC (0x4F4D454D)
+
+/* storage of 'm', its offset is taken relative to the load address */
+static struct memo_store *memo_store(const struct memo *m)
+{
+	return (struct memo_store *)(__pic_base + (u32)m->store);
+}
+
+static struct memo_slot *memo_slots(struct memo_store *s)
+{
+	return (struct memo_slot *)(s + 1);
+}
+
+static u8 *memo_ring(const struct memo *m, struct memo_store *s)
+{
+	return (u8 *)(memo_slots(s) + m->nr_slots);
+}
+
+/* word copy if both ends are aligned, the ring always is */
+static void memo_copy(void *dst, const void *src, u32 size)
+{
+	u8 *d = dst;
+	const u8 *p = src;
+	u32 i = 0;
+
+	if (0 == (((u32)d | (u32)p) & 3)) {
+		for (; i + 4 <= size; i += 4) {
+			*(u32 *)(d + i) = *(const u32 *)(p + i);
+		}
+	}
+	for (; i < size; i++) {
+		d[i] = p[i];
+	}
+}
+
+/* first word of the image digest, differs between images */
+static u32 memo_salt(void)
+{
+	const u8 *d = __image_header.digest;
+
+	return d[0] | d[1] << 8 | d[2] << 16 | (u32)d[3] << 24;
+}
+
+/* empties every slot, the header is written last */
+static void memo_clear(const struct memo *m, struct memo_store *s)
+{
+	struct memo_slot *slot = memo_slots(s);
+	u32 i;
+
+	s->magic = 0;
+	for (i = 0; i < m->nr_slots; i++) {
+		slot[i].stamp = 0;
+	}
+	s->clock = 0;
+	s->head = 0;
+	s->salt = memo_salt();
+	s->nr_slots = m->nr_slots;
+	s->budget = m->budget;
+	s->magic = MEMO_MAGIC;
+}
+
+/*
+ * storage of 'm', emptied first if it was left by another image or never
+ * written: .noinit holds whatever was in the memory before
+ */
+static struct memo_store *memo_open(const struct memo *m)
+{
+	struct memo_store *s = memo_store(m);
+
+	if (MEMO_MAGIC != s->magic || memo_salt() != s->salt ||
+		m->nr_slots != s->nr_slots || m->budget != s->budget) {
+		memo_clear(m, s);
+	}
+
+	return s;
+}
+
+/* next stamp, 0 marks empty slots */
+static u32 memo_tick(struct memo_store *s)
+{
+	if (0 == ++s->clock) {
+		s->clock = 1;
+	}
+
+	return s->clock;
+}
+
+/* word compare if 'p' is aligned, the ring always is */
+static bool memo_equal(const u8 *cached, const void *in, u32 len)
+{
+	const u8 *p = in;
+	u32 i = 0;
+
+	if (0 == ((u32)p & 3)) {
+		for (; i + 4 <= len; i += 4) {
+			if (*(const u32 *)(cached + i) != *(const u32 *)(p + i)) {
+				return false;
+			}
+		}
+	}
+	for (; i < len; i++) {
+		if (cached[i] != p[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* bytes of the ring a slot's entry takes, its input padded to a word */
+static u32 memo_span(const struct memo_slot *slot)
+{
+	return ((slot->len + 3) & ~3) + slot->size;
+}
+
+/* the hash only selects the slots, the input is compared byte for byte */
+static bool memo_match(const struct memo *m, struct memo_store *s,
+					   const struct memo_slot *slot, const struct memo_key *k)
+{
+	u32 i;
+
+	if (0 == slot->stamp || slot->hash != k->hash || slot->len != k->len) {
+		return false;
+	}
+	for (i = 0; i < MEMO_ARGS; i++) {
+		if (slot->args[i] != k->args[i]) {
+			return false;
+		}
+	}
+
+	return memo_equal(memo_ring(m, s) + slot->off, k->in, k->len);
+}
+
+/* slot holding 'k' or NULL */
+static struct memo_slot *memo_find(const struct memo *m, struct memo_store *s,
+								   const struct memo_key *k)
+{
+	struct memo_slot *slot = memo_slots(s);
+	u32 probe = (m->nr_slots < MEMO_PROBE ? m->nr_slots : MEMO_PROBE);
+	u32 i;
+
+	for (i = 0; i < probe; i++) {
+		if (memo_match(m, s, &slot[(k->hash + i) & (m->nr_slots - 1)], k)) {
+			return &slot[(k->hash + i) & (m->nr_slots - 1)];
+		}
+	}
+
+	return NULL;
+}
+
+/* slot for a new key: an empty one or else the least recently hit one */
+static struct memo_slot *memo_victim(const struct memo *m,
+									 struct memo_store *s, u32 hash)
+{
+	struct memo_slot *slot = memo_slots(s);
+	struct memo_slot *victim = NULL;
+	u32 probe = (m->nr_slots < MEMO_PROBE ? m->nr_slots : MEMO_PROBE);
+	u32 i, age, oldest = 0;
+
+	for (i = 0; i < probe; i++) {
+		struct memo_slot *c = &slot[(hash + i) & (m->nr_slots - 1)];
+
+		if (0 == c->stamp) {
+			return c;
+		}
+		age = s->clock - c->stamp;
+		if (NULL == victim || age > oldest) {
+			victim = c;
+			oldest = age;
+		}
+	}
+
+	return victim;
+}
+
+/* empties the slots whose entries overlap [off, off + size) of the ring */
+static void memo_evictRange(struct memo *m, struct memo_store *s, u32 off,
+							u32 size)
+{
+	struct memo_slot *slot = memo_slots(s);
+	u32 i;
+
+	for (i = 0; i < m->nr_slots; i++) {
+		u32 span = memo_span(&slot[i]);
+
+		if (0 != slot[i].stamp && 0 != span && slot[i].off < off + size &&
+			off < slot[i].off + span) {
+			slot[i].stamp = 0;
+			m->evictions++;
+		}
+	}
+}
+
+/**
+ * Hashes the argument words and the input bytes of a key.
+ *
+ * @param k - key, its hash is set
+ */
+void memo_hash(struct memo_key *k)
+{
+	k->hash = xxh32(k->in, k->len, xxh32(k->args, sizeof(k->args), 0));
+}
+
+/**
+ * Looks a call up and copies its result.
+ *
+ * @param m - cache
+ * @param k - key, hashed by memo_hash()
+ * @param ret - return value of the call
+ * @param out - result of the call
+ * @param max - room at 'out', a larger result is a miss
+ *
+ * @return bytes of the result, or MEMO_MISS
+ */
+int memo_get(struct memo *m, const struct memo_key *k, s32 *ret, void *out,
+			 u32 max)
+{
+	struct memo_store *s = memo_open(m);
+	struct memo_slot *slot = memo_find(m, s, k);
+
+	if (NULL == slot || slot->size > max) {
+		m->misses++;
+		return MEMO_MISS;
+	}
+
+	slot->stamp = memo_tick(s);
+	memo_copy(out, memo_ring(m, s) + slot->off + ((slot->len + 3) & ~3),
+			  slot->size);
+	*ret = slot->ret;
+	m->hits++;
+
+	return slot->size;
+}
+
+/**
+ * Caches the input and the result of a call, evicting the least recently hit
+ * key of the probed slots and the entries the new one overwrites in the ring.
+ * Entries larger than the ring are not cached.
+ *
+ * @param m - cache
+ * @param k - key, hashed by memo_hash()
+ * @param ret - return value of the call
+ * @param out - result of the call
+ * @param size - bytes of the result
+ */
+void memo_put(struct memo *m, const struct memo_key *k, s32 ret,
+			  const void *out, u32 size)
+{
+	struct memo_store *s = memo_open(m);
+	struct memo_slot *slot;
+	u32 in_size = (k->len + 3) & ~3;
+	u32 need = in_size + ((size + 3) & ~3);
+	u32 i;
+
+	/* the sum must not wrap for huge inputs */
+	if (in_size > m->budget || need > m->budget) {
+		return;
+	}
+
+	slot = memo_find(m, s, k);
+	if (NULL == slot) {
+		slot = memo_victim(m, s, k->hash);
+		if (0 != slot->stamp) {
+			m->evictions++;
+		}
+	}
+	/* the slot is empty while it is rewritten */
+	slot->stamp = 0;
+
+	if (s->head + need > m->budget) {
+		s->head = 0;
+	}
+	memo_evictRange(m, s, s->head, need);
+	memo_copy(memo_ring(m, s) + s->head, k->in, k->len);
+	memo_copy(memo_ring(m, s) + s->head + in_size, out, size);
+
+	slot->hash = k->hash;
+	slot->len = k->len;
+	for (i = 0; i < MEMO_ARGS; i++) {
+		slot->args[i] = k->args[i];
+	}
+	slot->ret = ret;
+	slot->off = s->head;
+	slot->size = size;
+	slot->stamp = memo_tick(s);
+	s->head += need;
+	m->inserts++;
+}
+
+/**
+ * Drops every cached result and clears the counters.
+ *
+ * @param m - cache
+ */
+void memo_reset(struct memo *m)
+{
+	memo_clear(m, memo_store(m));
+	m->hits = 0;
+	m->misses = 0;
+	m->inserts = 0;
+	m->evictions = 0;
+}
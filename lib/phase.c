@@ -0,0 +1,63 @@
+/**
+ * @file
+ *
+ * Switching between the phases of the overlaid .bss, see phase.h.
+ */
+
+#include <stddef.h>
+
+#include "phase.h"
+
+const char *phase_active;
+u32 phase_faults;
+
+/**
+ * Makes the phase 'name' active, its buffers [start, end) are zeroed. Use
+ * phase_enter().
+ *
+ * @param name - name of the phase
+ * @param start - first byte of the phase's buffers
+ * @param end - end of the phase's buffers
+ */
+void __phase_enter(const char *name, u8 *start, u8 *end)
+{
+	u8 *p;
+
+	phase_active = name;
+	for (p = start; p < end; p++) {
+		*p = 0;
+	}
+}
+
+/**
+ * Counts an access to a buffer at 'p' unless it lies in the buffers
+ * [start, end) of the phase 'name' and that phase is the active one. Use
+ * PHASE_ACCESS(), the phases are not overlaid with PIC_PHASE_CHECK.
+ *
+ * @param name - name of the phase the buffer is accessed as
+ * @param p - first byte of the buffer
+ * @param start - first byte of the phase's buffers
+ * @param end - end of the phase's buffers
+ */
+void __phase_check(const char *name, const u8 *p, const u8 *start,
+				   const u8 *end)
+{
+	const char *active = phase_active;
+
+	if (p < start || p >= end) {
+		phase_faults++;
+		return;
+	}
+
+	/* the names are compared, equal literals are not always merged */
+	if (NULL != active) {
+		while ('\0' != *name && *name == *active) {
+			name++;
+			active++;
+		}
+		if (*name == *active) {
+			return;
+		}
+	}
+	phase_faults++;
+}
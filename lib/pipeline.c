@@ -0,0 +1,598 @@
+/**
+ * @file
+ *
+ * Implementation of streaming dataflow pipelines, including the UART
+ * source and sink stages.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "pipeline.h"
+#include "sha256.h"
+#include "codec.h"
+#include "aaci.h"
+#include "export.h"
+#include "timer.h"
+#include "uart.h"
+
+/* time for uart_writev() to take a whole chain, in the UART sink */
+HISTOGRAM(uart_write_latency, "uart write");
+
+/**
+ * Initializes an empty queue.
+ *
+ * @param q - queue to initialize
+ * @param slots - storage of the queue
+ * @param nr_slots - number of slots, must be a power of 2
+ */
+void buf_queue_init(struct buf_queue *q, struct buf **slots, u32 nr_slots)
+{
+	q->slots = slots;
+	q->mask = nr_slots - 1;
+	q->head = 0;
+	q->tail = 0;
+	q->max_depth = 0;
+}
+
+/**
+ * @param q - queue
+ *
+ * @return number of buffers in the queue
+ */
+u32 buf_queue_depth(const struct buf_queue *q) { return q->head - q->tail; }
+
+/**
+ * Appends a buffer to the queue.
+ *
+ * @param q - queue
+ * @param buf - buffer to append
+ *
+ * @return false if the queue is full
+ */
+bool buf_queue_put(struct buf_queue *q, struct buf *buf)
+{
+	u32 depth = buf_queue_depth(q);
+
+	if (depth > q->mask) {
+		return false;
+	}
+
+	q->slots[q->head & q->mask] = buf;
+	q->head++;
+	if (++depth > q->max_depth) {
+		q->max_depth = depth;
+	}
+
+	return true;
+}
+
+/**
+ * Takes the oldest buffer from the queue.
+ *
+ * @param q - queue
+ *
+ * @return the buffer or NULL if the queue is empty
+ */
+struct buf *buf_queue_get(struct buf_queue *q)
+{
+	struct buf *buf;
+
+	if (q->head == q->tail) {
+		return NULL;
+	}
+
+	buf = q->slots[q->tail & q->mask];
+	q->tail++;
+
+	return buf;
+}
+
+/**
+ * Initializes a stage. 'in' is NULL for a source, 'out' is NULL for a sink.
+ *
+ * @param st - stage to initialize
+ * @param name - name of the stage, for the statistics
+ * @param fn - processing function
+ * @param ctx - stage specific data, available as st->ctx
+ * @param in - input queue
+ * @param out - output queue
+ */
+void stage_init(struct stage *st, const char *name, stage_fn fn, void *ctx,
+				struct buf_queue *in, struct buf_queue *out)
+{
+	st->name = name;
+	st->fn = fn;
+	st->ctx = ctx;
+	st->in = in;
+	st->out = out;
+	st->stats.calls = 0;
+	st->stats.bufs = 0;
+	st->stats.bytes = 0;
+	st->stats.ticks = 0;
+	st->hist = NULL;
+	st->next = NULL;
+}
+
+/**
+ * Passes a buffer to the next stage. pipeline_step() reserves room in the
+ * output queue before it invokes the stage, so this can not fail as long
+ * as the stage emits at most one buffer per input buffer.
+ *
+ * @param st - current stage
+ * @param buf - buffer to pass on
+ */
+void stage_emit(struct stage *st, struct buf *buf)
+{
+	if (NULL == st->out || !buf_queue_put(st->out, buf)) {
+		/* no place to go, should not happen */
+		buf_free(buf);
+	}
+}
+
+/**
+ * Initializes an empty pipeline.
+ *
+ * @param p - pipeline to initialize
+ */
+void pipeline_init(struct pipeline *p)
+{
+	p->first = NULL;
+	p->last = NULL;
+}
+
+/**
+ * Appends a stage to the pipeline. Stages are invoked in the order they
+ * have been added, which should be the order of the data flow.
+ *
+ * @param p - pipeline
+ * @param st - initialized stage
+ */
+void pipeline_add(struct pipeline *p, struct stage *st)
+{
+	st->next = NULL;
+	if (NULL == p->last) {
+		p->first = st;
+	} else {
+		p->last->next = st;
+	}
+	p->last = st;
+}
+
+/**
+ * Invokes every stage once with as many buffers as are available in its
+ * input queue, limited by the room in its output queue and PIPELINE_BATCH.
+ *
+ * @param p - pipeline
+ *
+ * @return true if any buffer has been moved, false if the pipeline is idle
+ */
+bool pipeline_step(struct pipeline *p)
+{
+	struct buf *bufs[PIPELINE_BATCH];
+	struct stage *st;
+	bool busy = false;
+
+	for (st = p->first; NULL != st; st = st->next) {
+		u32 n = PIPELINE_BATCH;
+		u32 i, emitted, bytes, start;
+
+		if (NULL != st->out) {
+			u32 room = st->out->mask + 1 - buf_queue_depth(st->out);
+			n = (room < n ? room : n);
+		}
+		if (NULL != st->in) {
+			u32 depth = buf_queue_depth(st->in);
+			n = (depth < n ? depth : n);
+		}
+		if (0 == n) {
+			continue;
+		}
+
+		for (i = 0; NULL != st->in && i < n; i++) {
+			bufs[i] = buf_queue_get(st->in);
+		}
+		emitted = (NULL != st->out ? st->out->head : 0);
+
+		start = timer_getValue(EXPORT_TIMER_NR, EXPORT_TIMER_CTR);
+		bytes = st->fn(st, (NULL != st->in ? bufs : NULL), n);
+		start -= timer_getValue(EXPORT_TIMER_NR, EXPORT_TIMER_CTR);
+		st->stats.ticks += start;
+
+		if (NULL == st->in) {
+			/* a source may have nothing to produce */
+			n = st->out->head - emitted;
+			if (0 == n) {
+				continue;
+			}
+		}
+
+		if (NULL != st->hist) {
+			histogram_record(st->hist, start);
+		}
+		st->stats.calls++;
+		st->stats.bufs += n;
+		st->stats.bytes += bytes;
+		busy = true;
+	}
+
+	return busy;
+}
+
+/**
+ * Source stage, reads the characters received by a UART into buffers
+ * allocated from the stage's pool. The context is a struct uart_stage.
+ */
+u32 pipeline_uart_source(struct stage *st, struct buf **bufs, u32 n)
+{
+	struct uart_stage *ctx = st->ctx;
+	u32 bytes = 0;
+
+	(void)bufs;
+	for (; n > 0; --n) {
+		struct buf *buf = buf_alloc(ctx->pool);
+
+		if (NULL == buf) {
+			break;
+		}
+
+		buf->len = uart_read(ctx->nr, buf->data, buf_tailroom(buf));
+		if (0 == buf->len) {
+			buf_free(buf);
+			break;
+		}
+
+		bytes += buf->len;
+		stage_emit(st, buf);
+	}
+
+	return bytes;
+}
+
+/**
+ * Sink stage, transmits the buffer chains by a UART straight from their
+ * segments and releases them. The context is a struct uart_stage, its pool
+ * is not used.
+ */
+u32 pipeline_uart_sink(struct stage *st, struct buf **bufs, u32 n)
+{
+	struct uart_stage *ctx = st->ctx;
+	struct iovec iov[PIPELINE_IOV];
+	u32 bytes = 0;
+	u32 i;
+
+	for (i = 0; i < n; i++) {
+		struct buf *seg = bufs[i];
+		u32 start = timer_getValue(EXPORT_TIMER_NR, EXPORT_TIMER_CTR);
+
+		while (NULL != seg) {
+			u32 cnt = buf_iov(seg, iov, PIPELINE_IOV);
+			u32 j;
+
+			if (0 == cnt) {
+				/* only empty segments are left */
+				break;
+			}
+			uart_writev(ctx->nr, iov, cnt);
+			/* skip the segments just written, including empty ones */
+			for (j = 0; NULL != seg && j < cnt; seg = seg->next) {
+				if (0 != seg->len) {
+					bytes += seg->len;
+					j++;
+				}
+			}
+		}
+		histogram_record(&uart_write_latency,
+						 start - timer_getValue(EXPORT_TIMER_NR, EXPORT_TIMER_CTR));
+		buf_free(bufs[i]);
+	}
+
+	return bytes;
+}
+
+/**
+ * Filter stage hashing the data flowing through it into the struct sha256
+ * in 'ctx', so the hash is ready when the last buffer has been received.
+ * Buffers are forwarded unchanged.
+ */
+u32 pipeline_sha256(struct stage *st, struct buf **bufs, u32 n)
+{
+	struct sha256 *ctx = st->ctx;
+	struct buf *seg;
+	u32 bytes = 0;
+	u32 i;
+
+	for (i = 0; i < n; i++) {
+		for (seg = bufs[i]; NULL != seg; seg = seg->next) {
+			sha256_update(ctx, seg->data, seg->len);
+			bytes += seg->len;
+		}
+		stage_emit(st, bufs[i]);
+	}
+
+	return bytes;
+}
+
+/*
+ * Returns the last buffer of the output chain '*chain' if it has room for
+ * 'need' more characters, otherwise a new one appended to the chain. NULL if
+ * the pool is exhausted.
+ */
+static struct buf *__chainRoom(struct pool *pool, struct buf **chain,
+							   struct buf *out, u32 need)
+{
+	struct buf *buf;
+
+	if (NULL != out && buf_tailroom(out) >= need) {
+		return out;
+	}
+	buf = buf_alloc(pool);
+	if (NULL == buf) {
+		return NULL;
+	}
+	if (NULL == *chain) {
+		*chain = buf;
+	} else {
+		out->next = buf;
+	}
+
+	return buf;
+}
+
+/*
+ * Encodes the chain 'in' as one line of text, a base64 group may straddle
+ * segments of 'in'. Returns the encoded chain, NULL if the pool is exhausted.
+ */
+static struct buf *__encodeChain(struct encode_stage *ctx, const struct buf *in)
+{
+	/* bytes in, characters out per encoder unit */
+	const u32 unit = (PIPELINE_HEX == ctx->format ? 1 : 3);
+	const u32 chars = (PIPELINE_HEX == ctx->format ? 2 : 4);
+	struct buf *chain = NULL;
+	struct buf *out = NULL;
+	u8 carry[3];
+	u32 nc = 0;
+	u32 left, k;
+	const u8 *p;
+	bool exhausted = false;
+
+	for (; NULL != in && !exhausted; in = in->next) {
+		for (p = in->data, left = in->len; left > 0 && !exhausted;) {
+			if (0 != nc || left < unit) {
+				/* a base64 group split between segments */
+				carry[nc++] = *p++;
+				left--;
+				if (nc < unit) {
+					continue;
+				}
+				nc = 0;
+				out = __chainRoom(ctx->pool, &chain, out, chars);
+				exhausted = (NULL == out);
+				if (!exhausted) {
+					base64_encode((char *)buf_put(out, chars), carry, unit);
+				}
+				continue;
+			}
+			out = __chainRoom(ctx->pool, &chain, out, chars);
+			if (NULL == out) {
+				exhausted = true;
+				continue;
+			}
+			k = left / unit;
+			if (k > buf_tailroom(out) / chars) {
+				k = buf_tailroom(out) / chars;
+			}
+			if (PIPELINE_HEX == ctx->format) {
+				hex_encode((char *)buf_put(out, k * chars), p, k);
+			} else {
+				base64_encode((char *)buf_put(out, k * chars), p, k * unit);
+			}
+			p += k * unit;
+			left -= k * unit;
+		}
+	}
+
+	/* padded last group, end of line */
+	if (!exhausted) {
+		out = __chainRoom(ctx->pool, &chain, out, (0 != nc ? chars : 0) + 1);
+	}
+	if (exhausted || NULL == out) {
+		buf_free(chain);
+		return NULL;
+	}
+	if (0 != nc) {
+		base64_encode((char *)buf_put(out, chars), carry, nc);
+	}
+	*buf_put(out, 1) = '\n';
+
+	return chain;
+}
+
+/**
+ * Filter stage encoding each chain as one line of hex or base64 text, for
+ * hosts that only accept printable characters. The context is a struct
+ * encode_stage, the encoded chains are allocated from its pool and the
+ * input chains are released. A chain that does not fit in the pool is
+ * dropped and counted.
+ */
+u32 pipeline_encode(struct stage *st, struct buf **bufs, u32 n)
+{
+	struct encode_stage *ctx = st->ctx;
+	struct buf *out;
+	u32 bytes = 0;
+	u32 i;
+
+	for (i = 0; i < n; i++) {
+		bytes += buf_chain_len(bufs[i]);
+		out = __encodeChain(ctx, bufs[i]);
+		buf_free(bufs[i]);
+		if (NULL == out) {
+			ctx->dropped++;
+			continue;
+		}
+		stage_emit(st, out);
+	}
+
+	return bytes;
+}
+
+/* bytes of one input sample (frame for stereo) of the PCM 'format' */
+static u32 __pcmUnit(u8 format)
+{
+	return (PIPELINE_PCM_U8 == format ? 1 : PIPELINE_PCM_S16 == format ? 2 : 4);
+}
+
+/* converts 'n' input samples at 'src' to AACI frames, mono to both sides */
+static void __pcmConvert(u32 *dst, const u8 *src, u32 n, u8 format)
+{
+	u32 i;
+	s16 s;
+
+	switch (format) {
+	case PIPELINE_PCM_U8:
+		for (i = 0; i < n; i++) {
+			s = (s16)((src[i] - 128) << 8);
+			dst[i] = AACI_FRAME(s, s);
+		}
+		break;
+	case PIPELINE_PCM_S16:
+		for (i = 0; i < n; i++, src += 2) {
+			s = (s16)(src[0] | src[1] << 8);
+			dst[i] = AACI_FRAME(s, s);
+		}
+		break;
+	default:
+		/* little endian left, right: already an AACI frame */
+		for (i = 0; i < n; i++, src += 4) {
+			dst[i] = src[0] | src[1] << 8 | src[2] << 16 | (u32)src[3] << 24;
+		}
+		break;
+	}
+}
+
+/*
+ * Converts the chain 'in', a sample may straddle segments of 'in' and a
+ * trailing partial sample is dropped. Returns the converted chain, NULL if
+ * the pool is exhausted or 'in' has no whole sample.
+ */
+static struct buf *__pcmChain(struct pcm_stage *ctx, const struct buf *in)
+{
+	const u32 unit = __pcmUnit(ctx->format);
+	struct buf *chain = NULL;
+	struct buf *out = NULL;
+	u8 carry[4];
+	u32 nc = 0;
+	u32 left, k;
+	const u8 *p;
+	bool exhausted = false;
+
+	for (; NULL != in && !exhausted; in = in->next) {
+		for (p = in->data, left = in->len; left > 0 && !exhausted;) {
+			if (0 != nc || left < unit) {
+				/* a sample split between segments */
+				carry[nc++] = *p++;
+				left--;
+				if (nc < unit) {
+					continue;
+				}
+				nc = 0;
+				out = __chainRoom(ctx->pool, &chain, out, 4);
+				exhausted = (NULL == out);
+				if (!exhausted) {
+					__pcmConvert((u32 *)buf_put(out, 4), carry, 1, ctx->format);
+				}
+				continue;
+			}
+			out = __chainRoom(ctx->pool, &chain, out, 4);
+			if (NULL == out) {
+				exhausted = true;
+				continue;
+			}
+			k = left / unit;
+			if (k > buf_tailroom(out) / 4) {
+				k = buf_tailroom(out) / 4;
+			}
+			__pcmConvert((u32 *)buf_put(out, k * 4), p, k, ctx->format);
+			p += k * unit;
+			left -= k * unit;
+		}
+	}
+
+	if (exhausted) {
+		buf_free(chain);
+		return NULL;
+	}
+
+	return chain;
+}
+
+/**
+ * Filter stage converting PCM samples to the AACI's 16-bit stereo frames,
+ * mono samples are played on both sides. The context is a struct
+ * pcm_stage, the converted chains are allocated from its pool, their
+ * segments hold whole, 4 byte aligned frames. The input chains are
+ * released, a chain that does not fit in the pool is dropped and counted.
+ */
+u32 pipeline_pcm(struct stage *st, struct buf **bufs, u32 n)
+{
+	struct pcm_stage *ctx = st->ctx;
+	struct buf *out;
+	u32 bytes = 0;
+	u32 len;
+	u32 i;
+
+	for (i = 0; i < n; i++) {
+		len = buf_chain_len(bufs[i]);
+		bytes += len;
+		out = __pcmChain(ctx, bufs[i]);
+		buf_free(bufs[i]);
+		if (NULL == out) {
+			if (len >= __pcmUnit(ctx->format)) {
+				ctx->dropped++;
+			}
+			continue;
+		}
+		stage_emit(st, out);
+	}
+
+	return bytes;
+}
+
+/**
+ * Sink stage, copies the frames of the chains (as emitted by pipeline_pcm)
+ * into the AACI's ring and releases them. While the ring is full it feeds
+ * the FIFO itself, the ticks spent waiting are the CPU headroom of the
+ * pipeline. The context is a struct aaci_stage.
+ */
+u32 pipeline_aaci_sink(struct stage *st, struct buf **bufs, u32 n)
+{
+	struct aaci_stage *ctx = st->ctx;
+	const struct buf *seg;
+	const u32 *frames;
+	u32 bytes = 0;
+	u32 left, k, start;
+	u32 i;
+
+	for (i = 0; i < n; i++) {
+		for (seg = bufs[i]; NULL != seg; seg = seg->next) {
+			frames = (const u32 *)seg->data;
+			for (left = seg->len / 4; left > 0; left -= k, frames += k) {
+				k = aaci_write(frames, left);
+				if (k < left) {
+					start = timer_getValue(EXPORT_TIMER_NR, EXPORT_TIMER_CTR);
+					while (0 == aaci_room()) {
+						aaci_poll();
+					}
+					ctx->wait +=
+						start - timer_getValue(EXPORT_TIMER_NR, EXPORT_TIMER_CTR);
+				}
+			}
+			bytes += seg->len;
+		}
+		buf_free(bufs[i]);
+	}
+	/* top up the FIFO in case its interrupt is not used */
+	aaci_poll();
+
+	return bytes;
+}
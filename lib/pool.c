@@ -0,0 +1,85 @@
+/**
+ * @file
+ *
+ * Implementation of fixed block size memory pools.
+ */
+
+#include <stddef.h>
+
+#include "pool.h"
+
+/**
+ * Initializes a pool over the memory area 'mem', which must be word
+ * aligned and at least POOL_MEM_SIZE(block_size, nr_blocks) bytes long.
+ *
+ * @param pool - pool to initialize
+ * @param mem - memory the blocks are carved from
+ * @param block_size - size of a block in bytes, rounded up to a word
+ * @param nr_blocks - number of blocks
+ */
+void pool_init(struct pool *pool, void *mem, u32 block_size, u32 nr_blocks)
+{
+	u8 *block = mem;
+	u32 i;
+
+	block_size = (block_size + 3) & ~3;
+	if (block_size < sizeof(void *)) {
+		block_size = sizeof(void *);
+	}
+
+	pool->free = NULL;
+	pool->block_size = block_size;
+	pool->nr_blocks = nr_blocks;
+	pool->nr_free = nr_blocks;
+	pool->min_free = nr_blocks;
+
+	/* Link the blocks in address order, the lowest one is allocated first */
+	block += block_size * nr_blocks;
+	for (i = 0; i < nr_blocks; i++) {
+		block -= block_size;
+		*(void **)block = pool->free;
+		pool->free = block;
+	}
+}
+
+/**
+ * Takes a block from the pool.
+ *
+ * @param pool - pool to allocate from
+ *
+ * @return the block or NULL if the pool is exhausted
+ */
+void *pool_alloc(struct pool *pool)
+{
+	void *block = pool->free;
+
+	if (NULL == block) {
+		return NULL;
+	}
+
+	pool->free = *(void **)block;
+	if (--pool->nr_free < pool->min_free) {
+		pool->min_free = pool->nr_free;
+	}
+
+	return block;
+}
+
+/**
+ * Returns a block to the pool it was allocated from.
+ *
+ * Nothing is done if 'block' is NULL.
+ *
+ * @param pool - pool the block belongs to
+ * @param block - block returned by pool_alloc()
+ */
+void pool_free(struct pool *pool, void *block)
+{
+	if (NULL == block) {
+		return;
+	}
+
+	*(void **)block = pool->free;
+	pool->free = block;
+	pool->nr_free++;
+}
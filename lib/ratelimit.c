@@ -0,0 +1,148 @@
+/**
+ * @file
+ *
+ * Token bucket rate limiting of console output, see ratelimit.h. Limiters
+ * are updated with IRQs masked (irq.h), so no drop is lost.
+ */
+
+#include <stdbool.h>
+
+#include "ratelimit.h"
+#include "export.h"
+#include "import.h"
+#include "irq.h"
+#include "timer.h"
+#include "uart.h"
+
+/* adds the ticks elapsed since the last refill, up to a full bucket */
+static void __refill(struct ratelimit *rl)
+{
+	u32 now = timer_getValue(EXPORT_TIMER_NR, EXPORT_TIMER_CTR);
+	/* the timer counts down, see timer_getValue() */
+	u32 elapsed = rl->last - now;
+
+	rl->last = now;
+	if (elapsed >= rl->limit - rl->credit) {
+		rl->credit = rl->limit;
+	} else {
+		rl->credit += elapsed;
+	}
+}
+
+/**
+ * Takes a token for one message.
+ *
+ * @param rl - limiter
+ *
+ * @return true if the message may be output, false if it is dropped and
+ * counted
+ */
+bool ratelimit_allow(struct ratelimit *rl)
+{
+	bool allow;
+	u32 cpsr = irq_save();
+
+	__refill(rl);
+	allow = (rl->credit >= rl->period);
+	if (allow) {
+		rl->credit -= rl->period;
+		rl->passed++;
+	} else {
+		rl->suppressed++;
+		rl->dropped++;
+	}
+	irq_restore(cpsr);
+
+	return allow;
+}
+
+/* takes the pending suppressed count, 0 if there is none */
+static u32 __takeSuppressed(struct ratelimit *rl)
+{
+	u32 cpsr = irq_save();
+	u32 n = rl->suppressed;
+
+	rl->suppressed = 0;
+	irq_restore(cpsr);
+
+	return n;
+}
+
+static void __printSummary(struct ratelimit *rl, u8 nr, u32 n)
+{
+	char digits[10];
+	int i = sizeof(digits);
+
+	do {
+		digits[--i] = '0' + n % 10;
+		n /= 10;
+	} while (0 != n);
+
+	uart_print(nr, (const char *)(__pic_base + (u32)rl->name));
+	uart_print(nr, ": ");
+	uart_write(nr, &digits[i], sizeof(digits) - i);
+	uart_print(nr, " messages suppressed\n");
+}
+
+/**
+ * Prints the pending "N messages suppressed" summary, if any, when the
+ * limiter has a token for it. Call it periodically, e.g. from an idle loop.
+ *
+ * @param rl - limiter
+ * @param nr - number of the UART
+ */
+void ratelimit_flush(struct ratelimit *rl, u8 nr)
+{
+	u32 n;
+
+	if (0 == rl->suppressed || !ratelimit_allow(rl)) {
+		return;
+	}
+	n = __takeSuppressed(rl);
+	if (0 != n) {
+		__printSummary(rl, nr, n);
+	}
+}
+
+/**
+ * uart_print() through a limiter, a pending summary is printed first.
+ *
+ * @param rl - limiter
+ * @param nr - number of the UART
+ * @param str - '\0' terminated message
+ */
+void ratelimit_print(struct ratelimit *rl, u8 nr, const char *str)
+{
+	u32 n;
+
+	if (!ratelimit_allow(rl)) {
+		return;
+	}
+	n = __takeSuppressed(rl);
+	if (0 != n) {
+		__printSummary(rl, nr, n);
+	}
+	uart_print(nr, str);
+}
+
+/**
+ * uart_write() through a limiter, a pending summary is written first.
+ *
+ * @param rl - limiter
+ * @param nr - number of the UART
+ * @param buf - message
+ * @param len - number of bytes of 'buf'
+ */
+void ratelimit_write(struct ratelimit *rl, u8 nr, const void *buf, u32 len)
+{
+	u32 n;
+
+	if (!ratelimit_allow(rl)) {
+		return;
+	}
+	n = __takeSuppressed(rl);
+	if (0 != n) {
+		__printSummary(rl, nr, n);
+	}
+	uart_write(nr, buf, len);
+}
@@ -0,0 +1,221 @@
+/**
+ * @file
+ *
+ * Implementation of the remote calls, the table of functions is generated
+ * (see rpc.h).
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "rpc.h"
+#include "uart.h"
+#include "xxhash.h"
+
+/* SLIP special bytes */
+#define SLIP_END	 (0xC0)
+#define SLIP_ESC	 (0xDB)
+#define SLIP_ESC_END (0xDC)
+#define SLIP_ESC_ESC (0xDD)
+
+/* Bytes read from the UART at once */
+#define RPC_RX_CHUNK (32)
+
+static u32 rpc_get32(const u8 *p)
+{
+	return p[0] | p[1] << 8 | p[2] << 16 | (u32)p[3] << 24;
+}
+
+static void rpc_put32(u8 *p, u32 value)
+{
+	p[0] = (u8)value;
+	p[1] = (u8)(value >> 8);
+	p[2] = (u8)(value >> 16);
+	p[3] = (u8)(value >> 24);
+}
+
+/* sends a reply frame, the leading END flushes noise the host received */
+static void rpc_reply(struct rpc *r, u8 id, u8 status, s32 ret)
+{
+	u8 msg[RPC_REPLY_SIZE];
+	u8 out[2 + 2 * RPC_REPLY_SIZE];
+	u32 i, n = 0;
+
+	msg[0] = id;
+	msg[1] = status;
+	msg[2] = 0;
+	msg[3] = 0;
+	rpc_put32(&msg[4], (u32)ret);
+	rpc_put32(&msg[8], xxh32(msg, 8, 0));
+
+	out[n++] = SLIP_END;
+	for (i = 0; i < RPC_REPLY_SIZE; i++) {
+		if (SLIP_END == msg[i]) {
+			out[n++] = SLIP_ESC;
+			out[n++] = SLIP_ESC_END;
+		} else if (SLIP_ESC == msg[i]) {
+			out[n++] = SLIP_ESC;
+			out[n++] = SLIP_ESC_ESC;
+		} else {
+			out[n++] = msg[i];
+		}
+	}
+	out[n++] = SLIP_END;
+	uart_write(r->nr, out, n);
+
+	if (RPC_OK == status) {
+		r->calls++;
+	} else {
+		r->rejected++;
+	}
+}
+
+/* checks the complete frame and queues the request it carries */
+static void rpc_request(struct rpc *r)
+{
+	const u8 *f = r->frame;
+	struct rpc_call *c;
+	u32 nr_args, i;
+
+	if (r->len < 8 || f[2] > RPC_ARGS || r->len != 8 + 4 * f[2] ||
+		rpc_get32(&f[r->len - 4]) != xxh32(f, r->len - 4, 0)) {
+		r->dropped++;
+		return;
+	}
+
+	nr_args = f[2];
+	if (rpc_nr_args(f[1]) < 0) {
+		rpc_reply(r, f[0], RPC_ENOENT, 0);
+		return;
+	}
+	if (rpc_nr_args(f[1]) != (int)nr_args) {
+		rpc_reply(r, f[0], RPC_EINVAL, 0);
+		return;
+	}
+	if (RPC_WINDOW == r->head - r->tail) {
+		rpc_reply(r, f[0], RPC_EBUSY, 0);
+		return;
+	}
+
+	c = &r->window[r->head % RPC_WINDOW];
+	c->id = f[0];
+	c->fn = f[1];
+	for (i = 0; i < RPC_ARGS; i++) {
+		c->args[i] = (i < nr_args ? rpc_get32(&f[4 + 4 * i]) : 0);
+	}
+	c->state = 0;
+	c->busy = true;
+	r->head++;
+}
+
+/* SLIP decodes a received byte, returns true if it completed a frame */
+static bool rpc_receive(struct rpc *r, u8 b)
+{
+	if (SLIP_END == b) {
+		if (!r->overflow && 0 != r->len) {
+			rpc_request(r);
+		}
+		r->len = 0;
+		r->esc = false;
+		r->overflow = false;
+		return true;
+	}
+
+	if (r->esc) {
+		r->esc = false;
+		if (SLIP_ESC_END == b) {
+			b = SLIP_END;
+		} else if (SLIP_ESC_ESC == b) {
+			b = SLIP_ESC;
+		}
+	} else if (SLIP_ESC == b) {
+		r->esc = true;
+		return false;
+	}
+
+	if (RPC_REQUEST_MAX == r->len) {
+		if (!r->overflow) {
+			r->dropped++;
+		}
+		r->overflow = true;
+		return false;
+	}
+	r->frame[r->len++] = b;
+
+	return false;
+}
+
+/* calls every queued request once, returns the number of replies sent */
+static int rpc_execute(struct rpc *r)
+{
+	struct rpc_call *c;
+	u32 i;
+	int ret, done = 0;
+
+	for (i = r->tail; i != r->head; i++) {
+		c = &r->window[i % RPC_WINDOW];
+		if (!c->busy) {
+			continue;
+		}
+		ret = rpc_call(c->fn, c->args, &c->state);
+		if (RPC_BUSY == ret && rpc_isPoll(c->fn)) {
+			continue;
+		}
+		c->busy = false;
+		rpc_reply(r, c->id, RPC_OK, ret);
+		done++;
+	}
+
+	/* the slots of completed requests are reused in order */
+	while (r->tail != r->head && !r->window[r->tail % RPC_WINDOW].busy) {
+		r->tail++;
+	}
+
+	return done;
+}
+
+/**
+ * @param r - server to initialize
+ * @param nr - number of the UART, its receiver is enabled
+ */
+void rpc_init(struct rpc *r, u8 nr)
+{
+	r->nr = nr;
+	r->len = 0;
+	r->esc = false;
+	r->overflow = false;
+	r->head = 0;
+	r->tail = 0;
+	r->calls = 0;
+	r->rejected = 0;
+	r->dropped = 0;
+	uart_enableRx(nr);
+}
+
+/**
+ * Receives the requests the UART holds and executes the queued ones,
+ * repeatedly until no more frame arrives. Poll functions still busy are
+ * called once per round. Never waits for the host.
+ *
+ * @param r - the server
+ *
+ * @return number of replies to completed calls sent
+ */
+int rpc_poll(struct rpc *r)
+{
+	u8 buf[RPC_RX_CHUNK];
+	u32 n, i, frames;
+	int done = 0;
+
+	do {
+		frames = 0;
+		while (0 != (n = uart_read(r->nr, buf, sizeof(buf)))) {
+			for (i = 0; i < n; i++) {
+				frames += rpc_receive(r, buf[i]);
+			}
+		}
+		done += rpc_execute(r);
+	} while (0 != frames);
+
+	return done;
+}
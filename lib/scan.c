@@ -0,0 +1,239 @@
+/**
+ * @file
+ *
+ * Implementation of the word at a time byte searches.
+ *
+ * For a word v, (v - 0x01010101) & ~v & 0x80808080 is non-zero if one of its
+ * bytes is zero. A borrow may also flag a byte above a zero byte, the lowest
+ * flag (little endian: the first byte) is always exact. Searching for c is
+ * searching for a zero in v ^ (c * 0x01010101).
+ *
+ * The main loops read SCAN_UNROLL words per iteration, which GCC turns into
+ * a single ldmia. SCAN_UNROLL and the instruction set (SCAN_TARGET) are
+ * knobs of the autotuner, see tune.h.
+ */
+
+#include <stddef.h>
+
+#include "scan.h"
+#include "tune.h"
+
+#if defined(__arm__)
+#define __PRAGMA(x)	  _Pragma(#x)
+#define __TARGET(isa) __PRAGMA(GCC target(isa))
+__TARGET(SCAN_TARGET)
+#endif
+
+#define ONES  (0x01010101u)
+#define HIGHS (0x80808080u)
+
+/* non-zero if a byte of v is zero, only the lowest flag is exact */
+#define HASZERO(v) (((v) - ONES) & ~(v) & HIGHS)
+
+/* exactly the high bit of each zero byte of v */
+static inline u32 __zeros(u32 v)
+{
+	return ~(((v & ~HIGHS) + ~HIGHS) | v) & HIGHS;
+}
+
+/* byte index of the lowest flag of a non-zero HASZERO() mask */
+static inline u32 __first(u32 mask)
+{
+	return (31 - __builtin_clz(mask & -mask)) >> 3;
+}
+
+/* number of flags of a __zeros() mask */
+static inline u32 __popcount(u32 mask)
+{
+	return ((mask >> 7) * ONES) >> 24;
+}
+
+/* non-zero if the byte b equals one of the 'n' replicated bytes */
+static inline u32 __matchByte(u8 b, const u32 *rep, u32 n)
+{
+	u32 i;
+
+	for (i = 0; i < n; i++) {
+		if ((u8)rep[i] == b) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* HASZERO() of v against each of the 'n' replicated bytes */
+static inline u32 __match(u32 v, const u32 *rep, u32 n)
+{
+	u32 mask = 0;
+	u32 i;
+
+	for (i = 0; i < n; i++) {
+		mask |= HASZERO(v ^ rep[i]);
+	}
+
+	return mask;
+}
+
+/*
+ * Index of the first byte of buf[0, len) that equals one of rep[] (bytes
+ * replicated to words), 'len' if there is none.
+ */
+static inline u32 __scan(const u8 *buf, u32 len, const u32 *rep, u32 n)
+{
+	const u8 *p = buf;
+	const u8 *end = buf + len;
+	const u32 *w;
+	u32 m, k;
+
+	/* bytes up to the first word boundary */
+	for (; p < end && 0 != ((size_t)p & 3); p++) {
+		if (0 != __matchByte(*p, rep, n)) {
+			return p - buf;
+		}
+	}
+
+	w = (const u32 *)p;
+	for (; (u32)(end - (const u8 *)w) >= SCAN_UNROLL * 4; w += SCAN_UNROLL) {
+		m = 0;
+		for (k = 0; k < SCAN_UNROLL; k++) {
+			m |= __match(w[k], rep, n);
+		}
+		if (0 != m) {
+			break;
+		}
+	}
+	for (; (u32)(end - (const u8 *)w) >= 4; w++) {
+		m = __match(*w, rep, n);
+		if (0 != m) {
+			return (const u8 *)w - buf + __first(m);
+		}
+	}
+
+	/* tail bytes */
+	for (p = (const u8 *)w; p < end; p++) {
+		if (0 != __matchByte(*p, rep, n)) {
+			return p - buf;
+		}
+	}
+
+	return len;
+}
+
+/**
+ * @param str - '\0' terminated string
+ *
+ * @return length of 'str'
+ */
+u32 scan_strlen(const char *str)
+{
+	const char *p = str;
+	const u32 *w;
+	u32 m;
+
+	for (; 0 != ((size_t)p & 3); p++) {
+		if ('\0' == *p) {
+			return p - str;
+		}
+	}
+
+	/*
+	 * Aligned words never cross the end of the string's page, so reading
+	 * past the terminator is safe.
+	 */
+	for (w = (const u32 *)p;; w++) {
+		m = HASZERO(*w);
+		if (0 != m) {
+			return (const char *)w - str + __first(m);
+		}
+	}
+}
+
+/**
+ * @param buf - bytes to search
+ * @param c - byte to search for
+ * @param len - number of bytes of 'buf'
+ *
+ * @return first byte of 'buf' equal to 'c', NULL if none is
+ */
+const void *scan_memchr(const void *buf, u8 c, u32 len)
+{
+	u32 rep = c * ONES;
+	u32 i = __scan(buf, len, &rep, 1);
+
+	return (i < len ? (const u8 *)buf + i : NULL);
+}
+
+/**
+ * @param buf - bytes to search
+ * @param len - number of bytes of 'buf'
+ *
+ * @return index of the first zero byte of 'buf', 'len' if there is none
+ */
+u32 scan_find_zero(const void *buf, u32 len)
+{
+	u32 rep = 0;
+
+	return __scan(buf, len, &rep, 1);
+}
+
+/**
+ * @param buf - bytes to search
+ * @param len - number of bytes of 'buf'
+ * @param set - bytes to search for
+ * @param nset - number of bytes of 'set', at most SCAN_SET_MAX are used
+ *
+ * @return index of the first byte of 'buf' found in 'set', 'len' if there is
+ * none
+ */
+u32 scan_find_any(const void *buf, u32 len, const u8 *set, u32 nset)
+{
+	u32 rep[SCAN_SET_MAX];
+	u32 i;
+
+	if (nset > SCAN_SET_MAX) {
+		nset = SCAN_SET_MAX;
+	}
+	for (i = 0; i < nset; i++) {
+		rep[i] = set[i] * ONES;
+	}
+
+	return __scan(buf, len, rep, nset);
+}
+
+/**
+ * @param buf - bytes to search
+ * @param len - number of bytes of 'buf'
+ * @param c - byte to count
+ *
+ * @return number of bytes of 'buf' equal to 'c'
+ */
+u32 scan_count(const void *buf, u32 len, u8 c)
+{
+	const u8 *p = buf;
+	const u8 *end = p + len;
+	const u32 *w;
+	u32 rep = c * ONES;
+	u32 n = 0;
+	u32 k;
+
+	for (; p < end && 0 != ((size_t)p & 3); p++) {
+		n += (*p == c);
+	}
+
+	w = (const u32 *)p;
+	for (; (u32)(end - (const u8 *)w) >= SCAN_UNROLL * 4; w += SCAN_UNROLL) {
+		for (k = 0; k < SCAN_UNROLL; k++) {
+			n += __popcount(__zeros(w[k] ^ rep));
+		}
+	}
+	for (; (u32)(end - (const u8 *)w) >= 4; w++) {
+		n += __popcount(__zeros(*w ^ rep));
+	}
+
+	for (p = (const u8 *)w; p < end; p++) {
+		n += (*p == c);
+	}
+
+	return n;
+}
@@ -0,0 +1,222 @@
+/**
+ * @file
+ *
+ * Implementation of SHA-256.
+ *
+ * The compression function is fully unrolled: instead of shifting the
+ * working variables after each round, the rounds are written with rotated
+ * variable names, so a to h stay in registers. Rotates become the barrel
+ * shifter operand of the eor/add instructions, and the 16 message words of
+ * an aligned block are read with ldmia.
+ */
+
+#include <stddef.h>
+
+#include "sha256.h"
+
+static const u32 K[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+	0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+	0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+	0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+	0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+	0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+#define ROR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+#define S0(x)		(ROR(x, 2) ^ ROR(x, 13) ^ ROR(x, 22))
+#define S1(x)		(ROR(x, 6) ^ ROR(x, 11) ^ ROR(x, 25))
+#define s0(x)		(ROR(x, 7) ^ ROR(x, 18) ^ ((x) >> 3))
+#define s1(x)		(ROR(x, 17) ^ ROR(x, 19) ^ ((x) >> 10))
+#define CH(x, y, z)	((z) ^ ((x) & ((y) ^ (z))))
+#define MAJ(x, y, z) (((x) & (y)) | ((z) & ((x) | (y))))
+
+/* W[i & 15] of rounds 16 to 63, computed in place of W[i - 16] */
+#define SCHEDULE(i)                                                            \
+	(W[(i) & 15] += s1(W[((i) - 2) & 15]) + W[((i) - 7) & 15] +               \
+					s0(W[((i) - 15) & 15]))
+
+#define ROUND(a, b, c, d, e, f, g, h, i, w)                                    \
+	do {                                                                       \
+		u32 t = h + S1(e) + CH(e, f, g) + K[i] + (w);                          \
+		d += t;                                                                \
+		h = t + S0(a) + MAJ(a, b, c);                                          \
+	} while (0)
+
+/* 8 rounds, after which the variables are back in their places */
+#define ROUNDS8(i, W)                                                          \
+	ROUND(a, b, c, d, e, f, g, h, (i) + 0, W((i) + 0));                        \
+	ROUND(h, a, b, c, d, e, f, g, (i) + 1, W((i) + 1));                        \
+	ROUND(g, h, a, b, c, d, e, f, (i) + 2, W((i) + 2));                        \
+	ROUND(f, g, h, a, b, c, d, e, (i) + 3, W((i) + 3));                        \
+	ROUND(e, f, g, h, a, b, c, d, (i) + 4, W((i) + 4));                        \
+	ROUND(d, e, f, g, h, a, b, c, (i) + 5, W((i) + 5));                        \
+	ROUND(c, d, e, f, g, h, a, b, (i) + 6, W((i) + 6));                        \
+	ROUND(b, c, d, e, f, g, h, a, (i) + 7, W((i) + 7))
+
+#define LOADED(i) W[i]
+
+/* big endian word, without ARMv6 rev */
+static inline u32 __be32(u32 x)
+{
+	u32 t = (x ^ ROR(x, 16)) & ~0x00ff0000;
+
+	return ROR(x, 8) ^ (t >> 8);
+}
+
+static void sha256_block(u32 *state, const u8 *data)
+{
+	u32 W[16];
+	u32 a, b, c, d, e, f, g, h;
+	u32 i;
+
+	if (0 == ((size_t)data & 3)) {
+		const u32 *p = (const u32 *)data;
+
+		for (i = 0; i < 16; i++) {
+			W[i] = __be32(p[i]);
+		}
+	} else {
+		for (i = 0; i < 16; i++, data += 4) {
+			W[i] = ((u32)data[0] << 24) | ((u32)data[1] << 16) |
+				   ((u32)data[2] << 8) | data[3];
+		}
+	}
+
+	a = state[0];
+	b = state[1];
+	c = state[2];
+	d = state[3];
+	e = state[4];
+	f = state[5];
+	g = state[6];
+	h = state[7];
+
+	ROUNDS8(0, LOADED);
+	ROUNDS8(8, LOADED);
+	ROUNDS8(16, SCHEDULE);
+	ROUNDS8(24, SCHEDULE);
+	ROUNDS8(32, SCHEDULE);
+	ROUNDS8(40, SCHEDULE);
+	ROUNDS8(48, SCHEDULE);
+	ROUNDS8(56, SCHEDULE);
+
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+	state[5] += f;
+	state[6] += g;
+	state[7] += h;
+}
+
+/**
+ * Starts a new hash.
+ *
+ * @param ctx - hash state
+ */
+void sha256_init(struct sha256 *ctx)
+{
+	static const u32 H0[8] = {
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+		0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+	};
+	u32 i;
+
+	for (i = 0; i < 8; i++) {
+		ctx->state[i] = H0[i];
+	}
+	ctx->len = 0;
+}
+
+/**
+ * Hashes the next 'len' bytes. Whole blocks are compressed directly from
+ * 'data', only a partial block is copied.
+ *
+ * @param ctx - hash state
+ * @param data - next bytes of the message
+ * @param len - number of bytes
+ */
+void sha256_update(struct sha256 *ctx, const void *data, u32 len)
+{
+	const u8 *p = data;
+	u32 used = (u32)ctx->len & (SHA256_BLOCK_SIZE - 1);
+
+	ctx->len += len;
+
+	if (0 != used) {
+		for (; used < SHA256_BLOCK_SIZE && len > 0; len--) {
+			ctx->block[used++] = *p++;
+		}
+		if (used < SHA256_BLOCK_SIZE) {
+			return;
+		}
+		sha256_block(ctx->state, ctx->block);
+	}
+
+	for (; len >= SHA256_BLOCK_SIZE; len -= SHA256_BLOCK_SIZE) {
+		sha256_block(ctx->state, p);
+		p += SHA256_BLOCK_SIZE;
+	}
+
+	for (used = 0; used < len; used++) {
+		ctx->block[used] = p[used];
+	}
+}
+
+/**
+ * Pads the message and returns the digest. 'ctx' must be initialized again
+ * before it is reused.
+ *
+ * @param ctx - hash state
+ * @param digest - the hash, big endian
+ */
+void sha256_final(struct sha256 *ctx, u8 digest[SHA256_DIGEST_SIZE])
+{
+	u64 bits = ctx->len << 3;
+	u32 used = (u32)ctx->len & (SHA256_BLOCK_SIZE - 1);
+	u32 i;
+
+	ctx->block[used++] = 0x80;
+	if (used > SHA256_BLOCK_SIZE - 8) {
+		for (; used < SHA256_BLOCK_SIZE; used++) {
+			ctx->block[used] = 0;
+		}
+		sha256_block(ctx->state, ctx->block);
+		used = 0;
+	}
+	for (; used < SHA256_BLOCK_SIZE - 8; used++) {
+		ctx->block[used] = 0;
+	}
+	for (i = 0; i < 8; i++) {
+		ctx->block[SHA256_BLOCK_SIZE - 1 - i] = (u8)(bits >> (8 * i));
+	}
+	sha256_block(ctx->state, ctx->block);
+
+	for (i = 0; i < SHA256_DIGEST_SIZE; i++) {
+		digest[i] = (u8)(ctx->state[i / 4] >> (24 - 8 * (i & 3)));
+	}
+}
+
+/**
+ * Hashes a whole message at once.
+ *
+ * @param data - the message
+ * @param len - number of bytes
+ * @param digest - the hash, big endian
+ */
+void sha256(const void *data, u32 len, u8 digest[SHA256_DIGEST_SIZE])
+{
+	struct sha256 ctx;
+
+	sha256_init(&ctx);
+	sha256_update(&ctx, data, len);
+	sha256_final(&ctx, digest);
+}
@@ -0,0 +1,265 @@
+/**
+ * @file
+ *
+ * Implementation of the command shell, the command table itself is
+ * generated (see shell.h).
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "shell.h"
+#include "ratelimit.h"
+#include "scan.h"
+#include "uart.h"
+
+/* UART of the shell running a command, for shell_print() */
+static u8 shell_uart;
+
+static const u8 shell_eol[] = {'\r', '\n'};
+
+/* error replies, a peer sending garbage must not saturate the UART */
+RATELIMIT(shell_errors, "shell errors", 10, 8);
+
+/**
+ * @param sh - shell to initialize
+ * @param nr - number of the UART, its receiver is enabled
+ */
+void shell_init(struct shell *sh, u8 nr)
+{
+	sh->nr = nr;
+	sh->len = 0;
+	sh->overflow = false;
+	sh->eol = '\0';
+	uart_enableRx(nr);
+	uart_print(nr, "> ");
+}
+
+/**
+ * Reads what the UART has received, echoes it and executes the complete
+ * lines. Lines end with CR, LF or CR LF. Error replies are rate limited.
+ * Never blocks.
+ *
+ * @param sh - the shell
+ *
+ * @return number of commands executed
+ */
+int shell_poll(struct shell *sh)
+{
+	u32 start, eol, rest, i;
+	int cmds = 0;
+	int ret;
+	char c;
+
+	/* characters before 'start' have been echoed */
+	start = sh->len;
+	sh->len += uart_read(sh->nr, &sh->line[sh->len], SHELL_LINE_MAX - 1 - sh->len);
+	shell_uart = sh->nr;
+
+	for (;;) {
+		eol = scan_find_any(sh->line, sh->len, shell_eol, sizeof(shell_eol));
+		if (eol == sh->len) {
+			break;
+		}
+		uart_write(sh->nr, &sh->line[start], eol - start);
+		c = sh->line[eol];
+		sh->line[eol] = '\0';
+
+		if ('\n' == c && '\r' == sh->eol && 0 == eol) {
+			/* LF of a CR LF */
+		} else if (sh->overflow) {
+			sh->overflow = false;
+			shell_print("\nline too long\n> ");
+		} else {
+			shell_print("\n");
+			ret = shell_exec(sh->line);
+			if (SHELL_ENOENT == ret) {
+				ratelimit_print(&shell_errors, sh->nr, "unknown command\n");
+			} else if (SHELL_E2BIG == ret) {
+				ratelimit_print(&shell_errors, sh->nr, "too many arguments\n");
+			} else if (ret < 0 && ratelimit_allow(&shell_errors)) {
+				shell_print("error ");
+				shell_printDec(-ret);
+				shell_print("\n");
+			}
+			cmds += (0 != eol);
+			shell_print("> ");
+		}
+		sh->eol = c;
+
+		/* keep the start of the next line */
+		rest = sh->len - eol - 1;
+		for (i = 0; i < rest; i++) {
+			sh->line[i] = sh->line[eol + 1 + i];
+		}
+		sh->len = rest;
+		start = 0;
+	}
+	uart_write(sh->nr, &sh->line[start], sh->len - start);
+	ratelimit_flush(&shell_errors, sh->nr);
+
+	if (SHELL_LINE_MAX - 1 == sh->len) {
+		/* no end of line in a full buffer, drop until the next one */
+		sh->overflow = true;
+		sh->len = 0;
+	}
+
+	return cmds;
+}
+
+/**
+ * Splits 'line' at blanks in place and calls the command named by the first
+ * argument.
+ *
+ * @param line - '\0' terminated command line, modified
+ *
+ * @return the command's return value, SHELL_ENOENT if it does not exist,
+ * SHELL_E2BIG if the line has more than SHELL_ARGS_MAX arguments
+ */
+int shell_exec(char *line)
+{
+	char *argv[SHELL_ARGS_MAX + 1];
+	int argc = 0;
+	int slot;
+	char *p = line;
+
+	for (;;) {
+		while (' ' == *p || '\t' == *p) {
+			*p++ = '\0';
+		}
+		if ('\0' == *p) {
+			break;
+		}
+		if (SHELL_ARGS_MAX == argc) {
+			return SHELL_E2BIG;
+		}
+		argv[argc++] = p;
+		while ('\0' != *p && ' ' != *p && '\t' != *p) {
+			p++;
+		}
+	}
+	argv[argc] = NULL;
+
+	if (0 == argc) {
+		return 0;
+	}
+	slot = shell_lookup(argv[0]);
+	if (slot < 0) {
+		return SHELL_ENOENT;
+	}
+
+	return shell_call(slot, argc, argv);
+}
+
+/**
+ * Prints to the UART of the shell running the command.
+ *
+ * @param str - '\0' terminated string
+ */
+void shell_print(const char *str) { uart_print(shell_uart, str); }
+
+/**
+ * Prints 'value' as 8 hex digits.
+ */
+void shell_printHex(u32 value)
+{
+	static const char digits[] = "0123456789abcdef";
+	char buf[8];
+	int i;
+
+	for (i = 7; i >= 0; i--, value >>= 4) {
+		buf[i] = digits[value & 0xf];
+	}
+	uart_write(shell_uart, buf, sizeof(buf));
+}
+
+/**
+ * Prints 'value' in decimal.
+ */
+void shell_printDec(u32 value)
+{
+	char buf[10];
+	int n = sizeof(buf);
+
+	do {
+		buf[--n] = '0' + value % 10;
+		value /= 10;
+	} while (0 != value);
+	uart_write(shell_uart, &buf[n], sizeof(buf) - n);
+}
+
+/**
+ * Parses a decimal or, with a "0x" prefix, hexadecimal number.
+ *
+ * @param str - the argument
+ * @param value - the number
+ *
+ * @return false if 'str' is not a number
+ */
+bool shell_parseU32(const char *str, u32 *value)
+{
+	u32 base = 10;
+	u32 v = 0;
+	u32 d;
+
+	if ('0' == str[0] && ('x' == str[1] || 'X' == str[1])) {
+		base = 16;
+		str += 2;
+	}
+	if ('\0' == *str) {
+		return false;
+	}
+	for (; '\0' != *str; str++) {
+		if (*str >= '0' && *str <= '9') {
+			d = *str - '0';
+		} else if (*str >= 'a' && *str <= 'f') {
+			d = *str - 'a' + 10;
+		} else if (*str >= 'A' && *str <= 'F') {
+			d = *str - 'A' + 10;
+		} else {
+			return false;
+		}
+		if (d >= base) {
+			return false;
+		}
+		v = v * base + d;
+	}
+	*value = v;
+
+	return true;
+}
+
+/**
+ * Seeded FNV-1a, the hash of the generated command table.
+ * scripts/cmdgen.py computes the same. The low bits of FNV-1a only depend on
+ * the low bits of the seed and the characters, so the table is indexed with
+ * the hash mixed once more.
+ */
+u32 shell_hash(const char *name, u32 seed)
+{
+	u32 h = 2166136261u ^ seed;
+
+	for (; '\0' != *name; name++) {
+		h = (h ^ (u8)*name) * 16777619u;
+	}
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+
+	return h ^ (h >> 13);
+}
+
+/**
+ * @return true if the strings are equal
+ */
+bool shell_streq(const char *a, const char *b)
+{
+	while (*a == *b) {
+		if ('\0' == *a) {
+			return true;
+		}
+		a++;
+		b++;
+	}
+
+	return false;
+}
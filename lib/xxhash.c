@@ -0,0 +1,90 @@
+/**
+ * @file
+ *
+ * Implementation of xxHash32, see xxhash.h.
+ *
+ * More info: https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+ */
+
+#include <stdbool.h>
+
+#include "xxhash.h"
+
+#define PRIME1 (0x9E3779B1u)
+#define PRIME2 (0x85EBCA77u)
+#define PRIME3 (0xC2B2AE3Du)
+#define PRIME4 (0x27D4EB2Fu)
+#define PRIME5 (0x165667B1u)
+
+static inline u32 xxh32_rotl(u32 x, u32 r) { return x << r | x >> (32 - r); }
+
+/* little endian word at 'p', a single load if 'aligned' */
+static inline u32 xxh32_read(const u8 *p, bool aligned)
+{
+	if (aligned) {
+		return *(const u32 *)p;
+	}
+	return p[0] | p[1] << 8 | p[2] << 16 | (u32)p[3] << 24;
+}
+
+static inline u32 xxh32_round(u32 v, u32 input)
+{
+	return xxh32_rotl(v + input * PRIME2, 13) * PRIME1;
+}
+
+/* inlined twice, 'aligned' is a constant in each copy */
+static inline u32 xxh32_body(const u8 *p, u32 len, u32 seed, bool aligned)
+{
+	const u8 *end = p + len;
+	u32 v1, v2, v3, v4;
+	u32 h;
+
+	if (len >= 16) {
+		v1 = seed + PRIME1 + PRIME2;
+		v2 = seed + PRIME2;
+		v3 = seed;
+		v4 = seed - PRIME1;
+		do {
+			v1 = xxh32_round(v1, xxh32_read(p, aligned));
+			v2 = xxh32_round(v2, xxh32_read(p + 4, aligned));
+			v3 = xxh32_round(v3, xxh32_read(p + 8, aligned));
+			v4 = xxh32_round(v4, xxh32_read(p + 12, aligned));
+			p += 16;
+		} while (end - p >= 16);
+		h = xxh32_rotl(v1, 1) + xxh32_rotl(v2, 7) + xxh32_rotl(v3, 12) +
+			xxh32_rotl(v4, 18);
+	} else {
+		h = seed + PRIME5;
+	}
+	h += len;
+
+	for (; end - p >= 4; p += 4) {
+		h = xxh32_rotl(h + xxh32_read(p, aligned) * PRIME3, 17) * PRIME4;
+	}
+	for (; p < end; p++) {
+		h = xxh32_rotl(h + *p * PRIME5, 11) * PRIME1;
+	}
+
+	h ^= h >> 15;
+	h *= PRIME2;
+	h ^= h >> 13;
+	h *= PRIME3;
+	h ^= h >> 16;
+
+	return h;
+}
+
+/**
+ * @param data - bytes to hash, any alignment
+ * @param len - number of bytes
+ * @param seed - different seeds give unrelated hashes of the same bytes
+ *
+ * @return XXH32 of the bytes
+ */
+u32 xxh32(const void *data, u32 len, u32 seed)
+{
+	if (0 == ((u32)data & 3)) {
+		return xxh32_body(data, len, seed, true);
+	}
+	return xxh32_body(data, len, seed, false);
+}
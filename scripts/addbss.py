@@ -7,15 +7,20 @@ parser.add_argument("elf", help="ELF file")
 parser.add_argument("bin", help="Binary file")
 parser.add_argument("withbss", help="Binary file with bss")
 
-def bss_size(elf_path):
+def image_end(elf_path):
 	binary: Binary = parse(elf_path)
-	try:
-		return binary.get_section(".bss").size
-	except(AttributeError):
-		return 0
+	end = 0
+	# .bss 之后是内部栈 .stack 及不清理的 .noinit，都不占用bin文件
+	for name in (".bss", ".stack", ".noinit"):
+		try:
+			section = binary.get_section(name)
+			end = max(end, section.virtual_address + section.size)
+		except(AttributeError):
+			pass
+	return end
 
 def appendbss(bin_path, elf_path, bin_with_bss_path):
-	filesize = path.getsize(bin_path) + bss_size(elf_path)
+	filesize = max(path.getsize(bin_path), image_end(elf_path))
 	with open(bin_with_bss_path, "wb") as f, open(bin_path, "rb") as r:
 		data = r.read()
 		f.write(data)
@@ -0,0 +1,121 @@
+from argparse import ArgumentParser
+from itertools import product
+from os import makedirs, path
+import json
+import re
+import subprocess
+import sys
+
+parser = ArgumentParser(description='Kernel autotuner, QEMU icount measurements')
+parser.add_argument("config", help="kernels and their tuning knobs (tune.json)")
+parser.add_argument("header", help="generated header selecting the variants (tune.h)")
+parser.add_argument("--build-dir", default="build/tune", help="variant builds and results.json")
+parser.add_argument("--toolchain", default="scripts/arm-none-eabi.cmake", help="CMake toolchain file")
+parser.add_argument("--qemu", default="qemu-system-arm")
+parser.add_argument("--timeout", type=int, default=60, help="seconds per QEMU run")
+parser.add_argument("--defaults", action="store_true", help="only write the defaults, no measurements")
+
+# "<name>: <ticks> ticks[, <bytes> bytes]", see app/bench.c
+REPORT = re.compile(r'^(.+): (\d+) ticks')
+
+# -icount shift=0: one instruction per ns, the 1 MHz export timer ticks every
+# 1000 instructions
+INSNS_PER_TICK = 1000
+
+class TuneError(Exception):
+	pass
+
+def variants(knobs):
+	names = sorted(knobs)
+	for values in product(*(knobs[n] for n in names)):
+		yield dict(zip(names, values))
+
+def variant_name(kernel, defs):
+	return kernel + "-" + "-".join(re.sub(r'\W', '', v) for _, v in sorted(defs.items()))
+
+def measure(args, kernel, spec, defs):
+	build = path.join(args.build_dir, variant_name(kernel, defs))
+	tune_defs = ";".join("%s=%s" % kv for kv in sorted(defs.items()))
+	subprocess.run(["cmake", "-S", ".", "-B", build,
+		"-DCMAKE_TOOLCHAIN_FILE=" + path.abspath(args.toolchain),
+		"-DPIC_EXPORTS=" + spec["bench"],
+		"-DPIC_TUNE_BENCH=" + spec["bench"],
+		"-DPIC_TUNE_DEFS=" + tune_defs], check=True, stdout=subprocess.DEVNULL)
+	subprocess.run(["cmake", "--build", build], check=True, stdout=subprocess.DEVNULL)
+	# the same machine as "just qemu", main exits through semihosting
+	run = subprocess.run([args.qemu, "-machine", "versatilepb", "-display", "none",
+		"-semihosting", "-serial", "stdio", "-icount", "shift=0",
+		"-kernel", path.join(build, "pic")],
+		capture_output=True, text=True, timeout=args.timeout)
+	ticks = 0
+	for line in run.stdout.splitlines():
+		m = REPORT.match(line)
+		if m and re.search(spec["report"], m.group(1)):
+			ticks += int(m.group(2))
+	if run.returncode != 0 or ticks == 0:
+		raise TuneError("%s %s: benchmark failed (exit %d)\n%s" % (kernel, tune_defs, run.returncode, run.stdout))
+	return ticks * INSNS_PER_TICK
+
+def write_header(header, config, chosen, results):
+	lines = [
+		"/**",
+		" * @file",
+		" *",
+		" * Tuning knobs of the kernels, generated by scripts/autotune.py from",
+		" * scripts/tune.json, do not edit. Run \"just tune\" to measure the variants.",
+	]
+	if not results:
+		lines += [
+			" *",
+			" * These are the defaults of scripts/tune.json, no variant has been",
+			" * measured (--defaults).",
+		]
+	lines += [
+		" *",
+		" * Builds may override single knobs with -D, see PIC_TUNE_DEFS.",
+	]
+	for kernel in sorted(results):
+		lines += [" *", " * %s, instructions (QEMU -icount):" % kernel]
+		for defs, insns in sorted(results[kernel], key=lambda r: r[1]):
+			knobs = " ".join("%s=%s" % kv for kv in sorted(defs.items()))
+			lines.append(" *   %10d  %s" % (insns, knobs))
+	lines += [
+		" */",
+		"",
+		"#ifndef _TUNE_H_",
+		"#define _TUNE_H_",
+	]
+	for kernel in sorted(config["kernels"]):
+		lines.append("")
+		lines.append("/* %s%s */" % (kernel, "" if kernel in results else ", default, not measured"))
+		for name, value in sorted(chosen[kernel].items()):
+			lines += ["#ifndef %s" % name, "#define %s %s" % (name, value), "#endif"]
+	lines += ["", "#endif /* _TUNE_H_ */", ""]
+	with open(header, "w") as f:
+		f.write("\n".join(lines))
+
+def tune(args, config):
+	chosen = {k: dict(spec["default"]) for k, spec in config["kernels"].items()}
+	results = {}
+	if not args.defaults:
+		makedirs(args.build_dir, exist_ok=True)
+		for kernel, spec in sorted(config["kernels"].items()):
+			results[kernel] = []
+			for defs in variants(spec["knobs"]):
+				insns = measure(args, kernel, spec, defs)
+				print("%s %s: %d instructions" % (kernel, " ".join("%s=%s" % kv for kv in sorted(defs.items())), insns))
+				results[kernel].append((defs, insns))
+			chosen[kernel] = min(results[kernel], key=lambda r: r[1])[0]
+		with open(path.join(args.build_dir, "results.json"), "w") as f:
+			json.dump(results, f, indent=1)
+	write_header(args.header, config, chosen, results)
+
+if __name__ == "__main__":
+	args = parser.parse_args()
+	with open(args.config) as f:
+		config = json.load(f)
+	try:
+		tune(args, config)
+	except (TuneError, subprocess.CalledProcessError, subprocess.TimeoutExpired) as e:
+		print("autotune: error: %s" % e, file=sys.stderr)
+		sys.exit(1)
@@ -0,0 +1,183 @@
+from argparse import ArgumentParser
+from os import path
+import re
+import sys
+
+parser = ArgumentParser(description='Shell command table generator (perfect hash)')
+parser.add_argument("commands", help="command list (*.cmd)")
+parser.add_argument("source", help="generated C source")
+
+# "<command> <handler> [# help]"
+LINE = re.compile(r'^(\S+)\s+([A-Za-z_]\w*)\s*(?:#\s*(.*))?$')
+NONE = 0xffff
+
+class CommandError(Exception):
+	pass
+
+# same as shell_hash() in lib/shell.c: FNV-1a, seeded, with a final mix
+def shell_hash(name, seed):
+	h = (2166136261 ^ seed) & 0xffffffff
+	for c in name.encode():
+		h = ((h ^ c) * 16777619) & 0xffffffff
+	h ^= h >> 16
+	h = (h * 0x85ebca6b) & 0xffffffff
+	return h ^ (h >> 13)
+
+def pow2(n):
+	p = 1
+	while p < n:
+		p <<= 1
+	return p
+
+def parse(cmd_path):
+	commands = []
+	with open(cmd_path) as f:
+		for n, line in enumerate(f, 1):
+			line = line.strip()
+			if not line or line.startswith("#"):
+				continue
+			m = LINE.match(line)
+			if m is None:
+				raise CommandError("%s:%d: bad command '%s'" % (cmd_path, n, line))
+			commands.append((m.group(1), m.group(2), m.group(3) or ""))
+	names = [c[0] for c in commands]
+	dup = set(x for x in names if names.count(x) > 1)
+	if dup:
+		raise CommandError("%s: duplicate commands %s" % (cmd_path, " ".join(sorted(dup))))
+	if not commands:
+		raise CommandError("%s: no command" % cmd_path)
+	return commands
+
+# hash and displace: the names of a bucket are placed with the bucket's seed
+def perfect_hash(names):
+	nr_buckets = pow2(max(1, len(names) // 4))
+	nr_slots = pow2(len(names) + len(names) // 4 + 1)
+	buckets = [[] for _ in range(nr_buckets)]
+	for name in names:
+		buckets[shell_hash(name, 0) & (nr_buckets - 1)].append(name)
+	seeds = [0] * nr_buckets
+	slots = [None] * nr_slots
+	for b in sorted(range(nr_buckets), key=lambda b: -len(buckets[b])):
+		if not buckets[b]:
+			continue
+		for seed in range(1, 0x10000):
+			want = [shell_hash(name, seed) & (nr_slots - 1) for name in buckets[b]]
+			if len(set(want)) == len(want) and all(slots[s] is None for s in want):
+				break
+		else:
+			raise CommandError("no perfect hash for bucket %d" % b)
+		seeds[b] = seed
+		for name, s in zip(buckets[b], want):
+			slots[s] = name
+	return seeds, slots
+
+def generate(cmd_path, commands, out):
+	seeds, slots = perfect_hash([c[0] for c in commands])
+	by_name = {c[0]: c for c in commands}
+	names, offsets, off = [], [], 0
+	for name in slots:
+		if name is None:
+			offsets.append(NONE)
+		else:
+			offsets.append(off)
+			names.append(name)
+			off += len(name) + 1
+	if off >= NONE:
+		raise CommandError("command names too long")
+
+	lines = [
+		"/* generated by scripts/cmdgen.py from %s, do not edit */" % path.basename(cmd_path),
+		"",
+		"#include <stddef.h>",
+		"",
+		"#include \"shell.h\"",
+		"",
+	]
+	for _, handler, _ in commands:
+		lines.append("int %s(int argc, char **argv);" % handler)
+	lines += [
+		"",
+		"#define NR_BUCKETS (%d)" % len(seeds),
+		"#define NR_SLOTS (%d)" % len(slots),
+		"#define NONE (0x%04x)" % NONE,
+		"",
+		"static const u16 shell_seeds[NR_BUCKETS] = {",
+		"\t" + ", ".join(str(s) for s in seeds) + ",",
+		"};",
+		"",
+		"/* names of the slots, NONE for an empty slot */",
+		"static const u16 shell_name_off[NR_SLOTS] = {",
+		"\t" + ", ".join("NONE" if o == NONE else str(o) for o in offsets) + ",",
+		"};",
+		"",
+		"static const char shell_names[] =",
+	]
+	lines += ["\t\"%s\\0\"" % n for n in names]
+	lines[-1] += ";"
+	lines += [
+		"",
+		"/* help texts, in slot order */",
+		"static const char *shell_help_text(u32 slot)",
+		"{",
+		"\tswitch (slot) {",
+	]
+	for slot, name in enumerate(slots):
+		if name is not None:
+			lines.append("\tcase %d: return \"%s\";" % (slot, by_name[name][2].replace("\\", "\\\\").replace("\"", "\\\"")))
+	lines += [
+		"\tdefault: return NULL;",
+		"\t}",
+		"}",
+		"",
+		"int shell_lookup(const char *name)",
+		"{",
+		"\tu32 seed = shell_seeds[shell_hash(name, 0) & (NR_BUCKETS - 1)];",
+		"\tu32 slot = shell_hash(name, seed) & (NR_SLOTS - 1);",
+		"",
+		"\tif (NONE == shell_name_off[slot] ||",
+		"\t\t!shell_streq(name, &shell_names[shell_name_off[slot]])) {",
+		"\t\treturn -1;",
+		"\t}",
+		"",
+		"\treturn slot;",
+		"}",
+		"",
+		"const char *shell_name(u32 slot, const char **help)",
+		"{",
+		"\tif (slot >= NR_SLOTS || NONE == shell_name_off[slot]) {",
+		"\t\treturn NULL;",
+		"\t}",
+		"\tif (NULL != help) {",
+		"\t\t*help = shell_help_text(slot);",
+		"\t}",
+		"",
+		"\treturn &shell_names[shell_name_off[slot]];",
+		"}",
+		"",
+		"/* direct calls, no table of function pointers to relocate */",
+		"int shell_call(u32 slot, int argc, char **argv)",
+		"{",
+		"\tswitch (slot) {",
+	]
+	for slot, name in enumerate(slots):
+		if name is not None:
+			lines.append("\tcase %d: return %s(argc, argv);" % (slot, by_name[name][1]))
+	lines += [
+		"\tdefault: return SHELL_ENOENT;",
+		"\t}",
+		"}",
+		"",
+		"u32 shell_nr_slots(void) { return NR_SLOTS; }",
+		"",
+	]
+	with open(out, "w") as f:
+		f.write("\n".join(lines))
+
+if __name__ == "__main__":
+	args = parser.parse_args()
+	try:
+		commands = parse(args.commands)
+		generate(args.commands, commands, args.source)
+	except CommandError as e:
+		print("cmdgen: error: %s" % e, file=sys.stderr)
+		sys.exit(1)
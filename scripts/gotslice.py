@@ -0,0 +1,158 @@
+from argparse import ArgumentParser
+from os import path
+import struct
+import sys
+
+from stackdepth import INDIRECT, StackError, located, parse_annotations, parse_ci, resolve, short_name
+
+parser = ArgumentParser(description='Per-export GOT slices')
+parser.add_argument("output", help="generated assembly source")
+parser.add_argument("objects", nargs="*", help="object files, *.ci is looked up next to them")
+parser.add_argument("--export", action="append", default=[], help="exported function (main, exports)")
+parser.add_argument("--common", action="append", default=[], help="function run by every export (export_begin...)")
+parser.add_argument("--annotations", help="targets of indirect calls, see scripts/stack.annot")
+
+SHT_SYMTAB, SHT_RELA, SHT_REL = 2, 4, 9
+STB_LOCAL = 0
+# relocations that make the linker allocate a GOT slot for the symbol
+R_ARM_GOT = {26: "R_ARM_GOT_BREL", 95: "R_ARM_GOT_ABS", 96: "R_ARM_GOT_PREL", 97: "R_ARM_GOT_BREL12"}
+# -ffunction-sections: .text.<func>, GCC may add a hotness prefix
+TEXT_PREFIXES = (".text.startup.", ".text.unlikely.", ".text.hot.", ".text.exit.", ".text.")
+
+class ElfError(Exception):
+	pass
+
+def sections(data):
+	if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+		raise ElfError("not a little endian ELF32 file")
+	shoff, = struct.unpack_from("<I", data, 0x20)
+	shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2e)
+	result = []
+	for i in range(shnum):
+		result.append(struct.unpack_from("<IIIIIIIIII", data, shoff + i * shentsize))
+	strtab = result[shstrndx]
+	def name(off):
+		start = strtab[4] + off
+		return data[start:data.index(b"\0", start)].decode()
+	return [(name(s[0]),) + s[1:] for s in result]
+
+def cstring(data, offset):
+	return data[offset:data.index(b"\0", offset)].decode()
+
+def function_of(section):
+	for prefix in TEXT_PREFIXES:
+		if section.startswith(prefix):
+			return section[len(prefix):]
+	return None
+
+def got_uses(obj_path, uses):
+	"""adds {function: {symbol}} of the GOT relocations of an object"""
+	with open(obj_path, "rb") as f:
+		data = f.read()
+	secs = sections(data)
+	for name, type_, flags, addr, offset, size, link, info, align, entsize in secs:
+		if type_ not in (SHT_REL, SHT_RELA):
+			continue
+		func = function_of(secs[info][0])
+		if func is None:
+			continue
+		symtab = secs[link]
+		symstr = secs[symtab[6]]
+		for rel in range(offset, offset + size, entsize):
+			r_info, = struct.unpack_from("<I", data, rel + 4)
+			if (r_info & 0xff) not in R_ARM_GOT:
+				continue
+			sym = symtab[4] + (r_info >> 8) * symtab[9]
+			st_name, st_value, st_size, st_info = struct.unpack_from("<IIIB", data, sym)
+			symbol = cstring(data, symstr[4] + st_name)
+			if (st_info >> 4) == STB_LOCAL or not symbol:
+				raise ElfError("%s: %s uses the GOT slot of local symbol '%s', it can not be named"
+					% (obj_path, func, symbol or "<section>"))
+			uses.setdefault(func, set()).add(symbol)
+
+def reachable(root, calls, indirect, frames, where):
+	"""titles of the functions reachable from root, callees without call graph are skipped"""
+	title = resolve(root, frames)
+	if title is None:
+		raise StackError("%s: no call graph information" % root)
+	seen, todo = set(), [title]
+	while todo:
+		func = todo.pop()
+		if func in seen:
+			continue
+		seen.add(func)
+		for callee in calls.get(func, ()):
+			if callee == INDIRECT:
+				targets = indirect.get(short_name(func))
+				if targets is None:
+					raise StackError("%s: indirect call without annotation" % located(func, where))
+			else:
+				targets = [callee]
+			for target in targets:
+				t = resolve(target, frames)
+				if t is not None:
+					todo.append(t)
+	return seen
+
+def slice_exports(args):
+	frames, calls, indirect, where, uses = {}, {}, {}, {}, {}
+	for obj in args.objects:
+		ci = path.splitext(obj)[0] + ".ci"
+		if path.exists(ci):
+			parse_ci(ci, frames, calls, where)
+		got_uses(obj, uses)
+	if args.annotations:
+		parse_annotations(args.annotations, frames, indirect)
+
+	def symbols(root):
+		# static functions of different files may share a name: their uses are merged
+		return set().union(*(uses.get(short_name(t), set()) for t in reachable(root, calls, indirect, frames, where)))
+
+	common = set().union(*(symbols(c) for c in args.common))
+	per_export = {e: symbols(e) | common for e in args.export}
+	# slots used by the same set of exports form a slice
+	owners = {}
+	for export, syms in per_export.items():
+		for sym in syms:
+			owners.setdefault(sym, set()).add(export)
+	slices = {}
+	for sym, exps in owners.items():
+		slices.setdefault(frozenset(exps), []).append(sym)
+	slices = sorted((sorted(exps), sorted(syms)) for exps, syms in slices.items())
+	return per_export, slices
+
+def generate(per_export, slices, out):
+	lines = ["/* generated by scripts/gotslice.py, do not edit */", ""]
+	lines += [
+		"/* per slice: base the slots are relocated to, number of slots, GOT offsets */",
+		".section .data.got_slices, \"aw\"",
+		"\t.p2align 2",
+	]
+	for i, (exps, syms) in enumerate(slices):
+		lines += ["/* %s */" % " ".join(exps), ".Lslice_%d:" % i, "\t.word 0", "\t.word %d" % len(syms)]
+		lines += ["\t.word %s(GOT)" % s for s in syms]
+	lines += [
+		"",
+		"/* per export: number of slices, their offsets */",
+		".section .rodata.got_slices, \"a\"",
+		"\t.p2align 2",
+	]
+	for export in sorted(per_export):
+		mine = [i for i, (exps, _) in enumerate(slices) if export in exps]
+		lines += ["\t.globl __got_slices_%s" % export, "__got_slices_%s:" % export, "\t.word %d" % len(mine)]
+		lines += ["\t.word .Lslice_%d" % i for i in mine]
+	with open(out, "w") as f:
+		f.write("\n".join(lines) + "\n")
+
+if __name__ == "__main__":
+	args = parser.parse_args()
+	try:
+		per_export, slices = slice_exports(args)
+	except (StackError, ElfError) as e:
+		print("gotslice: error: %s" % e, file=sys.stderr)
+		sys.exit(1)
+	generate(per_export, slices, args.output)
+	total = len(set().union(*(set(s) for _, s in slices))) if slices else 0
+	print("GOT slots relocated per export (of %d):" % total)
+	for export in sorted(per_export):
+		print("  %-24s %6d" % (export, len(per_export[export])))
@@ -0,0 +1,63 @@
+from lief import Binary,parse
+from argparse import ArgumentParser
+import struct
+
+parser = ArgumentParser(description='Latency histogram report')
+parser.add_argument("elf", help="ELF file")
+parser.add_argument("image", help="memory of the loaded image, dumped from its load address")
+parser.add_argument("--percentiles", default="50,90,99,99.9,99.99",
+	help="comma separated percentiles (default: %(default)s)")
+
+# struct histogram, see include/histogram.h
+HIST_SUB_BITS = 3
+HIST_SUB = 1 << HIST_SUB_BITS
+HIST_BUCKETS = (32 - HIST_SUB_BITS + 1) * HIST_SUB
+HIST_HEADER = 12
+HIST_SIZE = HIST_HEADER + 4 * HIST_BUCKETS
+
+def bucket_low(index):
+	if index < HIST_SUB:
+		return index
+	return (HIST_SUB + (index & (HIST_SUB - 1))) << ((index >> HIST_SUB_BITS) - 1)
+
+def bucket_high(index):
+	return bucket_low(index + 1) - 1 if index + 1 < HIST_BUCKETS else 0xffffffff
+
+def cstring(data, offset):
+	return data[offset:data.index(b"\0", offset)].decode()
+
+def histograms(elf_path, data):
+	binary: Binary = parse(elf_path)
+	# the image is linked at 0, addresses are offsets in the image
+	start = binary.get_symbol("__histograms_start__").value
+	end = binary.get_symbol("__histograms_end__").value
+	result = []
+	for offset in range(start, end, HIST_SIZE):
+		name, count, max_ = struct.unpack_from("<III", data, offset)
+		buckets = struct.unpack_from("<%dI" % HIST_BUCKETS, data, offset + HIST_HEADER)
+		result.append((cstring(data, name), count, max_, buckets))
+	return result
+
+# largest value of the bucket holding the percentile, at most the maximum
+def percentile(count, max_, buckets, p):
+	rank = max(1, -(-count * p // 100))
+	seen = 0
+	for index, n in enumerate(buckets):
+		seen += n
+		if seen >= rank:
+			return min(bucket_high(index), max_)
+	return max_
+
+def report(elf_path, data, percentiles):
+	names = ["p%s" % p for p in percentiles]
+	lines = [("%-16s %10s" + " %10s" * (len(names) + 1)) % tuple(["histogram", "count"] + names + ["max"])]
+	for name, count, max_, buckets in histograms(elf_path, data):
+		values = [percentile(count, max_, buckets, float(p)) if count else 0 for p in percentiles]
+		lines.append(("%-16s %10d" + " %10d" * (len(values) + 1)) % tuple([name, count] + values + [max_]))
+	return "\n".join(lines) + "\n"
+
+if __name__ == "__main__":
+	args = parser.parse_args()
+	with open(args.image, "rb") as f:
+		data = f.read()
+	print(report(args.elf, data, args.percentiles.split(",")), end="")
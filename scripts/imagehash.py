@@ -0,0 +1,47 @@
+from lief import Binary,parse
+from argparse import ArgumentParser
+import hashlib
+import struct
+
+parser = ArgumentParser(description='Image header digest')
+parser.add_argument("elf", help="ELF file")
+parser.add_argument("bin", help="Binary file, the digest is written in place")
+parser.add_argument("--check", action="store_true", help="only check the digest")
+
+# struct pic_image_header, see include/asm/image.h
+IMAGE_MAGIC = 0x49434950
+IMAGE_DIGEST = 8
+DIGEST_SIZE = 32
+
+class ImageError(Exception):
+	pass
+
+def header_offset(elf_path):
+	binary: Binary = parse(elf_path)
+	# the image is linked at 0, the address is the offset in the binary
+	return binary.get_symbol("__image_header").value
+
+def digest(data, offset):
+	magic, ro_size = struct.unpack_from("<II", data, offset)
+	if magic != IMAGE_MAGIC:
+		raise ImageError("bad image header magic 0x%08x" % magic)
+	field = offset + IMAGE_DIGEST
+	h = hashlib.sha256()
+	h.update(data[:field])
+	h.update(bytes(DIGEST_SIZE))
+	h.update(data[field + DIGEST_SIZE:ro_size])
+	return field, h.digest()
+
+if __name__ == "__main__":
+	args = parser.parse_args()
+	with open(args.bin, "rb") as f:
+		data = bytearray(f.read())
+	field, value = digest(data, header_offset(args.elf))
+	if args.check:
+		if data[field:field + DIGEST_SIZE] != value:
+			raise SystemExit("imagehash: %s: digest mismatch" % args.bin)
+	else:
+		data[field:field + DIGEST_SIZE] = value
+		with open(args.bin, "wb") as f:
+			f.write(data)
+	print(value.hex())
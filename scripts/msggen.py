@@ -0,0 +1,196 @@
+from argparse import ArgumentParser
+from os import path
+import re
+import sys
+
+parser = ArgumentParser(description='Fixed layout message generator')
+parser.add_argument("schema", help="message schema (*.msg)")
+parser.add_argument("header", help="generated C header")
+parser.add_argument("python", help="generated python module")
+
+# type: (size, struct format)
+TYPES = {
+	"u8": (1, "B"), "s8": (1, "b"),
+	"u16": (2, "H"), "s16": (2, "h"),
+	"u32": (4, "I"), "s32": (4, "i"),
+	"u64": (8, "Q"), "s64": (8, "q"),
+}
+# a tail is described by { u32 offset; u32 count; } in the fixed part
+TAIL_SIZE = 8
+
+MESSAGE = re.compile(r'message\s+(\w+)\s*\{([^}]*)\}', re.S)
+FIELD = re.compile(r'^(tail\s+)?(\w+)\s+(\w+)(?:\[(\d+)\])?$')
+
+class SchemaError(Exception):
+	pass
+
+class Field:
+	def __init__(self, name, type_, count, tail, offset):
+		self.name, self.type, self.count, self.tail, self.offset = name, type_, count, tail, offset
+		self.size = TAIL_SIZE if tail else TYPES[type_][0] * count
+
+def parse(schema_path):
+	with open(schema_path) as f:
+		text = re.sub(r'#.*', '', f.read())
+	messages = []
+	for m in MESSAGE.finditer(text):
+		name, body = m.group(1), m.group(2)
+		fields, offset, align, pad = [], 0, 1, 0
+		for decl in filter(None, (d.strip() for d in body.split(";"))):
+			f = FIELD.match(" ".join(decl.split()))
+			if f is None or f.group(2) not in TYPES:
+				raise SchemaError("%s: bad field '%s'" % (name, decl))
+			tail = f.group(1) is not None
+			if tail and f.group(4):
+				raise SchemaError("%s.%s: a tail has no fixed count" % (name, f.group(3)))
+			if not tail and fields and fields[-1].tail:
+				raise SchemaError("%s.%s: fixed fields must precede the tails" % (name, f.group(3)))
+			a = 4 if tail else TYPES[f.group(2)][0]
+			if offset % a:
+				fields.append(Field("__pad%d" % pad, "u8", a - offset % a, False, offset))
+				offset += a - offset % a
+				pad += 1
+			field = Field(f.group(3), f.group(2), int(f.group(4) or 1), tail, offset)
+			fields.append(field)
+			offset += field.size
+			align = max(align, a)
+		if offset % align:
+			fields.append(Field("__pad%d" % pad, "u8", align - offset % align, False, offset))
+			offset += align - offset % align
+		messages.append((name, fields, offset, align))
+	if not messages:
+		raise SchemaError("%s: no message" % schema_path)
+	return messages
+
+def gen_header(schema, messages, out):
+	guard = "_%s_H_" % path.splitext(path.basename(out))[0].upper()
+	lines = [
+		"/* generated by scripts/msggen.py from %s, do not edit */" % path.basename(schema),
+		"",
+		"#ifndef %s" % guard,
+		"#define %s" % guard,
+		"",
+		"#include <stddef.h>",
+		"#if defined(PIC_HOST)",
+		"#include <stdint.h>",
+		"typedef uint8_t u8;",
+		"typedef int8_t s8;",
+		"typedef uint16_t u16;",
+		"typedef int16_t s16;",
+		"typedef uint32_t u32;",
+		"typedef int32_t s32;",
+		"typedef uint64_t u64;",
+		"typedef int64_t s64;",
+		"#else",
+		"#include <types.h>",
+		"#endif",
+		"",
+		"#ifndef _MSG_TAIL_",
+		"#define _MSG_TAIL_",
+		"/* variable length tail, 'offset' is relative to the start of the message */",
+		"struct msg_tail {",
+		"\tu32 offset;",
+		"\tu32 count;",
+		"};",
+		"#endif",
+	]
+	for name, fields, size, align in messages:
+		upper = name.upper()
+		lines += ["", "struct %s {" % name]
+		for f in fields:
+			if f.tail:
+				lines.append("\tstruct msg_tail %s; /* %d: %s[] */" % (f.name, f.offset, f.type))
+			elif f.count > 1 or f.name.startswith("__pad"):
+				lines.append("\t%s %s[%d]; /* %d */" % (f.type, f.name, f.count, f.offset))
+			else:
+				lines.append("\t%s %s; /* %d */" % (f.type, f.name, f.offset))
+		lines += ["} __attribute__((aligned(%d)));" % align, ""]
+		lines.append("#define %s_SIZE (%d)" % (upper, size))
+		lines.append("_Static_assert(sizeof(struct %s) == %s_SIZE, \"%s layout\");" % (name, upper, name))
+		for f in fields:
+			if not f.name.startswith("__pad"):
+				lines.append("_Static_assert(offsetof(struct %s, %s) == %d, \"%s.%s layout\");"
+					% (name, f.name, f.offset, name, f.name))
+		for f in (f for f in fields if f.tail):
+			elem = TYPES[f.type][0]
+			lines += [
+				"",
+				"static inline const %s *%s_%s(const struct %s *m)" % (f.type, name, f.name, name),
+				"{",
+				"\treturn (const %s *)((const u8 *)m + m->%s.offset);" % (f.type, f.name),
+				"}",
+				"",
+				"/*",
+				" * Places the %s tail at the first %d byte aligned offset not below *used," % (f.name, max(elem, 4)),
+				" * *used is the number of bytes of the message written so far.",
+				" */",
+				"static inline %s *%s_%s_init(struct %s *m, u32 *used, u32 count)" % (f.type, name, f.name, name),
+				"{",
+				"\tu32 offset = (*used + %d) & ~%d;" % (max(elem, 4) - 1, max(elem, 4) - 1),
+				"",
+				"\tm->%s.offset = offset;" % f.name,
+				"\tm->%s.count = count;" % f.name,
+				"\t*used = offset + count * %d;" % elem,
+				"\treturn (%s *)((u8 *)m + offset);" % f.type,
+				"}",
+			]
+	lines += ["", "#endif /* %s */" % guard, ""]
+	with open(out, "w") as f:
+		f.write("\n".join(lines))
+
+def gen_python(schema, messages, out):
+	lines = [
+		"# generated by scripts/msggen.py from %s, do not edit" % path.basename(schema),
+		"import struct",
+		"",
+	]
+	for name, fields, size, align in messages:
+		cls = "".join(w.capitalize() for w in name.split("_"))
+		lines += [
+			"class %s:" % cls,
+			"\t\"\"\"In place view of a %s message, fields are read on access\"\"\"" % name,
+			"\tSIZE = %d" % size,
+			"",
+			"\tdef __init__(self, buf, offset=0):",
+			"\t\tself._buf = memoryview(buf)",
+			"\t\tself._off = offset",
+			"",
+		]
+		for f in fields:
+			if f.name.startswith("__pad"):
+				continue
+			fmt = TYPES[f.type][1]
+			lines.append("\t@property")
+			if f.tail:
+				elem = TYPES[f.type][0]
+				lines += [
+					"\tdef %s(self):" % f.name,
+					"\t\toffset, count = struct.unpack_from(\"<II\", self._buf, self._off + %d)" % f.offset,
+					"\t\tstart = self._off + offset",
+					"\t\treturn self._buf[start:start + count * %d].cast(\"%s\")" % (elem, fmt),
+				]
+			elif f.count > 1:
+				lines += [
+					"\tdef %s(self):" % f.name,
+					"\t\tstart = self._off + %d" % f.offset,
+					"\t\treturn self._buf[start:start + %d].cast(\"%s\")" % (f.size, fmt),
+				]
+			else:
+				lines += [
+					"\tdef %s(self):" % f.name,
+					"\t\treturn struct.unpack_from(\"<%s\", self._buf, self._off + %d)[0]" % (fmt, f.offset),
+				]
+			lines.append("")
+		lines.append("")
+	with open(out, "w") as f:
+		f.write("\n".join(lines).rstrip("\n") + "\n")
+
+if __name__ == "__main__":
+	args = parser.parse_args()
+	try:
+		messages = parse(args.schema)
+	except SchemaError as e:
+		print("msggen: error: %s" % e, file=sys.stderr)
+		sys.exit(1)
+	gen_header(args.schema, messages, args.header)
+	gen_python(args.schema, messages, args.python)
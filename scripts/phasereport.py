@@ -0,0 +1,35 @@
+from lief import Binary,parse
+from argparse import ArgumentParser
+
+parser = ArgumentParser(description='Phase overlay report')
+parser.add_argument("elf", help="ELF file")
+parser.add_argument("report", help="report file")
+
+PREFIX = ".phase."
+
+def phases(elf_path):
+	binary: Binary = parse(elf_path)
+	return [(s.name[len(PREFIX):], s.virtual_address, s.size)
+		for s in binary.sections if s.name.startswith(PREFIX)]
+
+def report(elf_path):
+	sections = phases(elf_path)
+	lines = ["%-24s %10s %8s" % ("phase", "address", "size")]
+	for name, address, size in sections:
+		lines.append("%-24s 0x%08x %8d" % (name, address, size))
+	total = sum(size for _, _, size in sections)
+	peak = max([size for _, _, size in sections] + [0])
+	lines.append("")
+	if len(set(address for _, address, _ in sections)) > 1:
+		# PIC_PHASE_CHECK lays the phases out one after another
+		lines.append("not overlaid, %d bytes, overlaid would be %d bytes" % (total, peak))
+	else:
+		lines.append("disjoint %d bytes, overlaid %d bytes, saved %d bytes" % (total, peak, total - peak))
+	return "\n".join(lines) + "\n"
+
+if __name__ == "__main__":
+	args = parser.parse_args()
+	text = report(args.elf)
+	with open(args.report, "w") as f:
+		f.write(text)
+	print(text, end="")
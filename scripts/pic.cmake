@@ -0,0 +1,244 @@
+# 位置无关blob的构建函数
+
+# 生成导出函数入口，每个函数一个<func>_entry veneer
+# pic_exports(<target> <func>...)
+function(pic_exports target)
+	set(PIC_EXPORT_VENEERS "")
+	foreach(export ${ARGN})
+		string(APPEND PIC_EXPORT_VENEERS "\tPIC_EXPORT ${export}\n")
+	endforeach()
+	configure_file(${CMAKE_SOURCE_DIR}/startup/exports.S.in ${CMAKE_CURRENT_BINARY_DIR}/${target}.S @ONLY)
+	add_library(${target} OBJECT ${CMAKE_CURRENT_BINARY_DIR}/${target}.S)
+endfunction()
+
+# 生成导入函数的stub，调用经由加载时填写的导入表跳转到共享blob
+# pic_imports(<target> <func>...)
+function(pic_imports target)
+	set(PIC_IMPORT_STUBS "")
+	foreach(import ${ARGN})
+		string(APPEND PIC_IMPORT_STUBS "\tPIC_IMPORT ${import}\n")
+	endforeach()
+	configure_file(${CMAKE_SOURCE_DIR}/startup/imports.S.in ${CMAKE_CURRENT_BINARY_DIR}/${target}.S @ONLY)
+	add_library(${target} OBJECT ${CMAKE_CURRENT_BINARY_DIR}/${target}.S)
+endfunction()
+
+# 由消息描述生成固定布局的C头文件(<name>_msg.h)及宿主用python模块(<name>_msg.py)
+# 生成的头文件路径追加到<var>，作为源文件加入目标以建立依赖
+# pic_messages(<var> <schema.msg>...)
+function(pic_messages var)
+	set(headers ${${var}})
+	foreach(schema ${ARGN})
+		get_filename_component(name ${schema} NAME_WE)
+		get_filename_component(schema ${schema} ABSOLUTE)
+		set(header ${CMAKE_CURRENT_BINARY_DIR}/${name}_msg.h)
+		set(module ${CMAKE_CURRENT_BINARY_DIR}/${name}_msg.py)
+		add_custom_command(
+			OUTPUT ${header} ${module}
+			COMMAND python3 ${CMAKE_SOURCE_DIR}/scripts/msggen.py ${schema} ${header} ${module}
+			DEPENDS ${schema} ${CMAKE_SOURCE_DIR}/scripts/msggen.py
+			COMMENT "Generate ${name} messages"
+			VERBATIM
+		)
+		list(APPEND headers ${header})
+	endforeach()
+	set(${var} ${headers} PARENT_SCOPE)
+endfunction()
+
+# 由命令列表(每行"<命令> <处理函数> [# 帮助]")生成shell的命令表(<name>_cmd.c)，
+# 编译期构造完美哈希，查找只需两次哈希和一次字符串比较，见shell.h
+# 生成的源文件路径追加到<var>
+# pic_commands(<var> <commands.cmd>...)
+function(pic_commands var)
+	set(sources ${${var}})
+	foreach(list ${ARGN})
+		get_filename_component(name ${list} NAME_WE)
+		get_filename_component(list ${list} ABSOLUTE)
+		set(source ${CMAKE_CURRENT_BINARY_DIR}/${name}_cmd.c)
+		add_custom_command(
+			OUTPUT ${source}
+			COMMAND python3 ${CMAKE_SOURCE_DIR}/scripts/cmdgen.py ${list} ${source}
+			DEPENDS ${list} ${CMAKE_SOURCE_DIR}/scripts/cmdgen.py
+			COMMENT "Generate ${name} command table"
+			VERBATIM
+		)
+		list(APPEND sources ${source})
+	endforeach()
+	set(${var} ${sources} PARENT_SCOPE)
+endfunction()
+
+# 由远程调用列表(每行"<函数> <参数个数> [poll] [# 帮助]")按顺序编号，生成直接调用各函数的
+# rpc_call()等(<name>_rpc.c)及宿主scripts/rpcclient.py使用的编号表(<name>_rpc.py)，见rpc.h
+# 生成的源文件路径追加到<var>
+# pic_rpcs(<var> <rpcs.rpc>...)
+function(pic_rpcs var)
+	set(sources ${${var}})
+	foreach(list ${ARGN})
+		get_filename_component(name ${list} NAME_WE)
+		get_filename_component(list ${list} ABSOLUTE)
+		set(source ${CMAKE_CURRENT_BINARY_DIR}/${name}_rpc.c)
+		set(module ${CMAKE_CURRENT_BINARY_DIR}/${name}_rpc.py)
+		add_custom_command(
+			OUTPUT ${source} ${module}
+			COMMAND python3 ${CMAKE_SOURCE_DIR}/scripts/rpcgen.py ${list} ${source} ${module}
+			DEPENDS ${list} ${CMAKE_SOURCE_DIR}/scripts/rpcgen.py
+			COMMENT "Generate ${name} remote call table"
+			VERBATIM
+		)
+		list(APPEND sources ${source})
+	endforeach()
+	set(${var} ${sources} PARENT_SCOPE)
+endfunction()
+
+# 链接blob并生成.bin及带bss的.bss.bin
+# add_pic_blob(<target> LIBS <object lib>... [EXPORTS <func>...] [STACK_LIBS <object lib>...]
+#              [PHASES <phase>...] [DIRECT])
+#   EXPORTS    导出函数，作为栈深度分析的入口
+#   DIRECT     导出函数由导入方直接调用而不经其veneer(共享blob)，PIC_GOT_SLICES时它们的got槽
+#              由main(__pic_lib_entry)首次调用时一并偏移
+#   STACK_LIBS 不链接进blob但在内部栈上运行的代码(共享blob中的导入函数)
+#   PHASES     互斥的阶段，各阶段的.bss(PHASE_BSS)重叠在同一地址范围，见phase.h
+function(add_pic_blob target)
+	cmake_parse_arguments(BLOB "DIRECT" "" "LIBS;EXPORTS;STACK_LIBS;PHASES" ${ARGN})
+	set(STACK_DIR ${CMAKE_CURRENT_BINARY_DIR}/${target}.ld)
+	file(MAKE_DIRECTORY ${STACK_DIR})
+
+	# pie.ld 中 INCLUDE 的 phase.ld，每个阶段一个OVERLAY段并定义其起止符号
+	# PIC_PHASE_CHECK时各阶段依次排列而不重叠，PHASE_ACCESS()可由地址判断缓冲区所属的阶段
+	set(PHASE_LD "/* generated by scripts/pic.cmake, do not edit */\n")
+	if (BLOB_PHASES AND PIC_PHASE_CHECK)
+		foreach(phase ${BLOB_PHASES})
+			string(APPEND PHASE_LD ".phase.${phase} : ALIGN(8) {\n")
+			string(APPEND PHASE_LD "\t__phase_${phase}_start__ = .;\n")
+			string(APPEND PHASE_LD "\t*(.bss.phase.${phase})\n")
+			string(APPEND PHASE_LD "\t__phase_${phase}_end__ = .;\n")
+			string(APPEND PHASE_LD "}\n")
+		endforeach()
+	elseif (BLOB_PHASES)
+		string(APPEND PHASE_LD "OVERLAY : NOCROSSREFS {\n")
+		foreach(phase ${BLOB_PHASES})
+			string(APPEND PHASE_LD "\t.phase.${phase} {\n")
+			string(APPEND PHASE_LD "\t\t__phase_${phase}_start__ = .;\n")
+			string(APPEND PHASE_LD "\t\t*(.bss.phase.${phase})\n")
+			string(APPEND PHASE_LD "\t\t__phase_${phase}_end__ = .;\n")
+			string(APPEND PHASE_LD "\t}\n")
+		endforeach()
+		string(APPEND PHASE_LD "}\n")
+	endif()
+	file(WRITE ${STACK_DIR}/phase.ld ${PHASE_LD})
+
+	# 各导出函数用到的got片段(startup.S中按片段延迟偏移)，由目标文件的got重定位及调用图生成
+	set(BLOB_OBJECTS "")
+	foreach(lib ${BLOB_LIBS})
+		list(APPEND BLOB_OBJECTS $<TARGET_OBJECTS:${lib}>)
+	endforeach()
+	set(SLICE_LIBS "")
+	if (PIC_GOT_SLICES)
+		set(SLICE_ARGS --annotations ${PIC_STACK_ANNOTATIONS})
+		foreach(export main ${BLOB_EXPORTS})
+			list(APPEND SLICE_ARGS --export ${export})
+		endforeach()
+		set(SLICE_COMMON export_begin export_end pic_import_resolve)
+		if (BLOB_DIRECT)
+			list(APPEND SLICE_COMMON ${BLOB_EXPORTS})
+		endif()
+		foreach(common ${SLICE_COMMON})
+			list(APPEND SLICE_ARGS --common ${common})
+		endforeach()
+		add_custom_command(
+			OUTPUT ${STACK_DIR}/got_slices.S
+			COMMAND python3 ${CMAKE_SOURCE_DIR}/scripts/gotslice.py
+				${SLICE_ARGS}
+				${STACK_DIR}/got_slices.S
+				${BLOB_OBJECTS}
+			DEPENDS ${BLOB_LIBS} ${BLOB_OBJECTS}
+				${CMAKE_SOURCE_DIR}/scripts/gotslice.py ${PIC_STACK_ANNOTATIONS}
+			COMMENT "Compute ${target} GOT slices"
+			COMMAND_EXPAND_LISTS
+			VERBATIM
+		)
+		add_library(${target}_got_slices OBJECT ${STACK_DIR}/got_slices.S)
+		set(SLICE_LIBS ${target}_got_slices)
+	endif()
+
+	add_executable(${target})
+	target_link_libraries(${target} PRIVATE ${BLOB_LIBS} ${SLICE_LIBS})
+	target_link_options(${target} PRIVATE -fPIE)
+	target_link_options(${target} PRIVATE -ffreestanding -nolibc -nostartfiles)
+	target_link_options(${target} PRIVATE -T ${CMAKE_SOURCE_DIR}/scripts/pie.ld)
+	# pie.ld 中 INCLUDE 的 stack.ld 位于构建目录
+	target_link_options(${target} PRIVATE -L${STACK_DIR})
+	target_link_options(${target} PRIVATE -Wl,--defsym=__stack_slots__=${PIC_STACK_SLOTS})
+	target_link_options(${target} PRIVATE -Wl,-Map=${CMAKE_SOURCE_DIR}/${target}.map)
+	if (DEFINED EXTERNSYMBOL_PATH)
+	target_link_options(${target} PRIVATE -Wl,-R=${EXTERNSYMBOL_PATH})
+	endif()
+	target_link_options(${target} PRIVATE -Wl,--gc-sections)
+
+	# 链接前计算最坏栈深度并生成stack.ld，存在递归或未标注的间接调用时失败
+	# 导出函数及__pic_enter中调用的函数都运行在内部栈上，__pic_enter另在栈顶保存
+	# 调用者sp、cpsr、r8-r11、占用标志、svc的sp、lr(FORCE_SVC)及r0-r3
+	set(STACK_ARGS --irq-nesting ${PIC_STACK_IRQ_NESTING} --annotations ${PIC_STACK_ANNOTATIONS})
+	list(APPEND STACK_ARGS --entry-frame 52)
+	foreach(root ${PIC_STACK_ROOTS} ${BLOB_EXPORTS} export_begin export_end pic_import_resolve)
+		list(APPEND STACK_ARGS --root ${root})
+	endforeach()
+	foreach(isr ${PIC_STACK_ISRS})
+		list(APPEND STACK_ARGS --isr ${isr})
+	endforeach()
+	set(STACK_OBJECTS ${BLOB_OBJECTS})
+	foreach(lib ${BLOB_STACK_LIBS})
+		list(APPEND STACK_OBJECTS $<TARGET_OBJECTS:${lib}>)
+	endforeach()
+	add_custom_command(
+		TARGET ${target}
+		PRE_LINK
+		COMMAND python3 ${CMAKE_SOURCE_DIR}/scripts/stackdepth.py
+			${STACK_ARGS}
+			${STACK_DIR}/stack.ld
+			${STACK_OBJECTS}
+		COMMENT "Compute ${target} stack depth"
+		COMMAND_EXPAND_LISTS
+		VERBATIM
+	)
+	# 各阶段大小及重叠节省的RAM
+	if (BLOB_PHASES)
+	add_custom_command(
+		TARGET ${target}
+		POST_BUILD
+		COMMAND python3 ${CMAKE_SOURCE_DIR}/scripts/phasereport.py
+			$<TARGET_FILE:${target}>
+			$<TARGET_FILE:${target}>.phase.txt
+		COMMENT "Report ${target} phase overlay"
+		VERBATIM
+	)
+	endif()
+	# 生成二进制文件
+	add_custom_command(
+		TARGET ${target}
+		POST_BUILD
+		COMMAND ${CMAKE_OBJCOPY} -O binary $<TARGET_FILE:${target}> $<TARGET_FILE:${target}>.bin
+		COMMENT "Make ${target} binary"
+		VERBATIM
+	)
+	# 在.bin的镜像头中填写只读部分的SHA-256
+	add_custom_command(
+		TARGET ${target}
+		POST_BUILD
+		COMMAND python3 ${CMAKE_SOURCE_DIR}/scripts/imagehash.py
+			$<TARGET_FILE:${target}>
+			$<TARGET_FILE:${target}>.bin
+		COMMENT "Sign ${target} binary"
+		VERBATIM
+	)
+	# 生成带bss的二进制文件
+	add_custom_command(
+		TARGET ${target}
+		POST_BUILD
+		COMMAND python3 ${CMAKE_SOURCE_DIR}/scripts/addbss.py
+			$<TARGET_FILE:${target}>
+			$<TARGET_FILE:${target}>.bin
+			$<TARGET_FILE:${target}>.bss.bin
+		COMMENT "Make ${target} binary with bss"
+		VERBATIM
+	)
+endfunction()
@@ -0,0 +1,229 @@
+from argparse import ArgumentParser
+from importlib.util import module_from_spec, spec_from_file_location
+import os
+import select
+import struct
+import sys
+import time
+
+parser = ArgumentParser(description='Pipelined remote calls to the blob over a QEMU serial pipe',
+	epilog='QEMU connects UART 2 to the pipe with: -serial stdio -serial null -serial pipe:<pipe>, '
+		'after mkfifo <pipe>.in <pipe>.out; the blob is built with PIC_RPC_SERVE')
+parser.add_argument("module", help="generated call table (<build>/app/rpcs_rpc.py)")
+parser.add_argument("pipe", help="path given to -serial pipe:")
+parser.add_argument("--window", type=int, default=8, help="outstanding calls (default: %(default)s)")
+parser.add_argument("--count", type=int, default=1000, help="calls per measurement (default: %(default)s)")
+parser.add_argument("--timeout", type=float, default=5, help="seconds to wait for a reply (default: %(default)s)")
+parser.add_argument("--call", nargs="+", metavar="ARG", help="call a function (name, then arguments) and print its return value")
+
+# include/rpc.h
+RPC_ARGS = 4
+RPC_WINDOW = 8
+RPC_OK, RPC_ENOENT, RPC_EINVAL, RPC_EBUSY = 0, 1, 2, 3
+RPC_REPLY_SIZE = 12
+STATUS = {RPC_ENOENT: "no such function", RPC_EINVAL: "wrong number of arguments"}
+
+SLIP_END, SLIP_ESC, SLIP_ESC_END, SLIP_ESC_ESC = 0xC0, 0xDB, 0xDC, 0xDD
+
+class RpcError(Exception):
+	pass
+
+# same as xxh32() in lib/xxhash.c
+PRIME1, PRIME2, PRIME3, PRIME4, PRIME5 = 0x9E3779B1, 0x85EBCA77, 0xC2B2AE3D, 0x27D4EB2F, 0x165667B1
+MASK = 0xffffffff
+
+def rotl(x, r):
+	return ((x << r) | (x >> (32 - r))) & MASK
+
+def xxh32(data, seed=0):
+	n, p = len(data), 0
+	if n >= 16:
+		v = [(seed + PRIME1 + PRIME2) & MASK, (seed + PRIME2) & MASK, seed, (seed - PRIME1) & MASK]
+		while n - p >= 16:
+			for i in range(4):
+				word = struct.unpack_from("<I", data, p + 4 * i)[0]
+				v[i] = (rotl((v[i] + word * PRIME2) & MASK, 13) * PRIME1) & MASK
+			p += 16
+		h = (rotl(v[0], 1) + rotl(v[1], 7) + rotl(v[2], 12) + rotl(v[3], 18)) & MASK
+	else:
+		h = (seed + PRIME5) & MASK
+	h = (h + n) & MASK
+	while n - p >= 4:
+		h = (rotl((h + struct.unpack_from("<I", data, p)[0] * PRIME3) & MASK, 17) * PRIME4) & MASK
+		p += 4
+	while p < n:
+		h = (rotl((h + data[p] * PRIME5) & MASK, 11) * PRIME1) & MASK
+		p += 1
+	h ^= h >> 15
+	h = (h * PRIME2) & MASK
+	h ^= h >> 13
+	h = (h * PRIME3) & MASK
+	return h ^ (h >> 16)
+
+def slip(payload):
+	out = bytearray([SLIP_END])
+	for b in payload:
+		if b == SLIP_END:
+			out += bytes([SLIP_ESC, SLIP_ESC_END])
+		elif b == SLIP_ESC:
+			out += bytes([SLIP_ESC, SLIP_ESC_ESC])
+		else:
+			out.append(b)
+	out.append(SLIP_END)
+	return bytes(out)
+
+class Client:
+	"""Keeps up to 'window' calls outstanding, replies are matched by ID"""
+
+	def __init__(self, rpcs, pipe, window, timeout):
+		self.rpcs = rpcs
+		self.window = max(1, min(window, RPC_WINDOW))
+		self.timeout = timeout
+		# QEMU reads <pipe>.in and writes <pipe>.out
+		self.tx = os.open(pipe + ".in", os.O_WRONLY)
+		self.rx = os.open(pipe + ".out", os.O_RDONLY)
+		self.pending = {}	# id: [name, frame, time sent]
+		self.done = {}		# id: (return value, round trip seconds)
+		self.order = []		# ids in the order their replies arrived
+		self.next_id = 0
+		self.frame, self.esc = bytearray(), False
+		self.sent = self.received = self.dropped = 0
+
+	def submit(self, name, *args):
+		if name not in self.rpcs:
+			raise RpcError("%s: not in the call table" % name)
+		fn, nr_args, _, _ = self.rpcs[name]
+		if len(args) != nr_args:
+			raise RpcError("%s: takes %d arguments" % (name, nr_args))
+		while len(self.pending) >= self.window:
+			self.receive()
+		id_ = self.free_id()
+		payload = struct.pack("<BBBB%dI" % nr_args, id_, fn, nr_args, 0, *(a & MASK for a in args))
+		frame = slip(payload + struct.pack("<I", xxh32(payload)))
+		self.pending[id_] = [name, frame, time.perf_counter()]
+		self.send(frame)
+		return id_
+
+	def result(self, id_):
+		while id_ not in self.done:
+			self.receive()
+		return self.done.pop(id_)
+
+	def call(self, name, *args):
+		return self.result(self.submit(name, *args))[0]
+
+	def free_id(self):
+		if len(self.pending) + len(self.done) >= 256:
+			raise RpcError("256 calls without their results collected")
+		while self.next_id in self.pending or self.next_id in self.done:
+			self.next_id = (self.next_id + 1) & 0xff
+		id_ = self.next_id
+		self.next_id = (id_ + 1) & 0xff
+		return id_
+
+	def send(self, frame):
+		os.write(self.tx, frame)
+		self.sent += len(frame)
+
+	def receive(self):
+		ready, _, _ = select.select([self.rx], [], [], self.timeout)
+		if not ready:
+			raise RpcError("no reply within %gs, %d calls outstanding" % (self.timeout, len(self.pending)))
+		data = os.read(self.rx, 4096)
+		if not data:
+			raise RpcError("the pipe was closed")
+		self.received += len(data)
+		for b in data:
+			if b == SLIP_END:
+				if self.frame:
+					self.reply(bytes(self.frame))
+				self.frame, self.esc = bytearray(), False
+			elif self.esc:
+				self.esc = False
+				self.frame.append({SLIP_ESC_END: SLIP_END, SLIP_ESC_ESC: SLIP_ESC}.get(b, b))
+			elif b == SLIP_ESC:
+				self.esc = True
+			else:
+				self.frame.append(b)
+
+	def reply(self, msg):
+		if len(msg) != RPC_REPLY_SIZE or xxh32(msg[:8]) != struct.unpack_from("<I", msg, 8)[0]:
+			self.dropped += 1
+			return
+		id_, status, ret = struct.unpack_from("<BBxxi", msg)
+		call = self.pending.pop(id_, None)
+		if call is None:
+			return
+		if status == RPC_EBUSY:
+			# the blob's window was full, send the request again
+			self.pending[id_] = call
+			self.send(call[1])
+		elif status != RPC_OK:
+			raise RpcError("%s: %s" % (call[0], STATUS.get(status, "status %d" % status)))
+		else:
+			self.done[id_] = (ret, time.perf_counter() - call[2])
+			self.order.append(id_)
+
+def percentile(values, p):
+	values = sorted(values)
+	return values[min(len(values) - 1, int(len(values) * p / 100))]
+
+# rpc_echo calls with 'window' outstanding
+def measure(client, count, window):
+	client.window = window
+	sent, received = client.sent, client.received
+	expect, ids, rtts = {}, [], []
+	start = time.perf_counter()
+	for i in range(count):
+		id_ = client.submit("rpc_echo", i)
+		expect[id_] = i
+		ids.append(id_)
+		while ids and ids[0] in client.done:
+			id_ = ids.pop(0)
+			ret, rtt = client.result(id_)
+			if ret != expect.pop(id_):
+				raise RpcError("rpc_echo returned %d" % ret)
+			rtts.append(rtt)
+	for id_ in ids:
+		ret, rtt = client.result(id_)
+		if ret != expect.pop(id_):
+			raise RpcError("rpc_echo returned %d" % ret)
+		rtts.append(rtt)
+	elapsed = time.perf_counter() - start
+	nr_bytes = client.sent - sent + client.received - received
+	print("rpc window %d: %d calls/s, %d bytes/s, rtt p50 %d us, p99 %d us" % (window,
+		count / elapsed, nr_bytes / elapsed, percentile(rtts, 50) * 1e6, percentile(rtts, 99) * 1e6))
+
+# calls submitted after a sleeping poll call complete before it
+def overtake(client):
+	client.window = RPC_WINDOW
+	client.order = []
+	sleep = client.submit("rpc_sleep", 50000)
+	echos = [client.submit("rpc_echo", i) for i in range(RPC_WINDOW - 1)]
+	client.result(sleep)
+	for id_ in echos:
+		client.result(id_)
+	first = client.order.index(sleep)
+	print("rpc out of order: %d of %d calls completed before rpc_sleep" % (first, len(echos)))
+	return first == len(echos)
+
+def load_table(module_path):
+	spec = spec_from_file_location("rpc_table", module_path)
+	module = module_from_spec(spec)
+	spec.loader.exec_module(module)
+	return module.RPCS
+
+if __name__ == "__main__":
+	args = parser.parse_args()
+	try:
+		client = Client(load_table(args.module), args.pipe, args.window, args.timeout)
+		if args.call:
+			print(client.call(args.call[0], *(int(a, 0) for a in args.call[1:])))
+			sys.exit(0)
+		measure(client, args.count, 1)
+		measure(client, args.count, args.window)
+		ok = overtake(client)
+	except RpcError as e:
+		print("rpcclient: error: %s" % e, file=sys.stderr)
+		sys.exit(1)
+	sys.exit(0 if ok else 1)
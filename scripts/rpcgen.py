@@ -0,0 +1,119 @@
+from argparse import ArgumentParser
+from os import path
+import re
+import sys
+
+parser = ArgumentParser(description='Remote call table generator')
+parser.add_argument("rpcs", help="function list (*.rpc)")
+parser.add_argument("source", help="generated C source")
+parser.add_argument("python", help="generated python module")
+
+# "<function> <arguments> [poll] [# help]"
+LINE = re.compile(r'^([A-Za-z_]\w*)\s+(\d+)(\s+poll)?\s*(?:#\s*(.*))?$')
+# include/rpc.h
+RPC_ARGS = 4
+# the function number is one byte of the request
+MAX_RPCS = 256
+
+class RpcError(Exception):
+	pass
+
+def parse(rpc_path):
+	rpcs = []
+	with open(rpc_path) as f:
+		for n, line in enumerate(f, 1):
+			line = line.strip()
+			if not line or line.startswith("#"):
+				continue
+			m = LINE.match(line)
+			if m is None:
+				raise RpcError("%s:%d: bad function '%s'" % (rpc_path, n, line))
+			if int(m.group(2)) > RPC_ARGS:
+				raise RpcError("%s:%d: more than %d arguments" % (rpc_path, n, RPC_ARGS))
+			rpcs.append((m.group(1), int(m.group(2)), m.group(3) is not None, m.group(4) or ""))
+	names = [r[0] for r in rpcs]
+	dup = set(x for x in names if names.count(x) > 1)
+	if dup:
+		raise RpcError("%s: duplicate functions %s" % (rpc_path, " ".join(sorted(dup))))
+	if not rpcs:
+		raise RpcError("%s: no function" % rpc_path)
+	if len(rpcs) > MAX_RPCS:
+		raise RpcError("%s: more than %d functions" % (rpc_path, MAX_RPCS))
+	return rpcs
+
+def gen_source(rpc_path, rpcs, out):
+	lines = [
+		"/* generated by scripts/rpcgen.py from %s, do not edit */" % path.basename(rpc_path),
+		"",
+		"#include <stdbool.h>",
+		"",
+		"#include \"rpc.h\"",
+		"",
+	]
+	for name, nr_args, poll, _ in rpcs:
+		params = ["u32 a%d" % i for i in range(nr_args)] + (["u32 *state"] if poll else [])
+		lines.append("int %s(%s);" % (name, ", ".join(params) or "void"))
+	lines += [
+		"",
+		"#define NR_RPCS (%d)" % len(rpcs),
+		"",
+		"static const u8 rpc_args[NR_RPCS] = {",
+		"\t" + ", ".join(str(r[1]) for r in rpcs) + ",",
+		"};",
+		"",
+		"/* -1 for an unknown function */",
+		"int rpc_nr_args(u32 fn) { return (fn < NR_RPCS ? rpc_args[fn] : -1); }",
+		"",
+		"bool rpc_isPoll(u32 fn)",
+		"{",
+		"\tswitch (fn) {",
+	]
+	polls = [(fn, r[0]) for fn, r in enumerate(rpcs) if r[2]]
+	lines += ["\tcase %d: /* %s */" % p for p in polls]
+	if polls:
+		lines.append("\t\treturn true;")
+	lines += [
+		"\tdefault:",
+		"\t\treturn false;",
+		"\t}",
+		"}",
+		"",
+		"/* direct calls, no table of function pointers to relocate */",
+		"int rpc_call(u32 fn, const u32 *args, u32 *state)",
+		"{",
+		"\tswitch (fn) {",
+	]
+	for fn, (name, nr_args, poll, _) in enumerate(rpcs):
+		params = ["args[%d]" % i for i in range(nr_args)] + (["state"] if poll else [])
+		lines.append("\tcase %d: return %s(%s);" % (fn, name, ", ".join(params)))
+	lines += [
+		"\tdefault: return 0;",
+		"\t}",
+		"}",
+		"",
+	]
+	with open(out, "w") as f:
+		f.write("\n".join(lines))
+
+def gen_python(rpc_path, rpcs, out):
+	lines = [
+		"# generated by scripts/rpcgen.py from %s, do not edit" % path.basename(rpc_path),
+		"",
+		"# name: (number, arguments, poll, help)",
+		"RPCS = {",
+	]
+	for fn, (name, nr_args, poll, help_) in enumerate(rpcs):
+		lines.append("\t%r: (%d, %d, %s, %r)," % (name, fn, nr_args, poll, help_))
+	lines += ["}", ""]
+	with open(out, "w") as f:
+		f.write("\n".join(lines))
+
+if __name__ == "__main__":
+	args = parser.parse_args()
+	try:
+		rpcs = parse(args.rpcs)
+	except RpcError as e:
+		print("rpcgen: error: %s" % e, file=sys.stderr)
+		sys.exit(1)
+	gen_source(args.rpcs, rpcs, args.source)
+	gen_python(args.rpcs, rpcs, args.python)
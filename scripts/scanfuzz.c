@@ -0,0 +1,189 @@
+/**
+ * @file
+ *
+ * Differential fuzzer of the SWAR kernels (lib/scan.c), built and run on the
+ * host by "just scanfuzz". Every kernel is compared against a bytewise
+ * reference over the four alignments and all lengths up to three unrolled
+ * iterations plus a tail of 0-7 bytes. One match is placed at each position
+ * in turn. The other bytes differ from the target by a single bit or by a
+ * borrow, so false flags above a match would show. A match just past the
+ * end must not be found.
+ *
+ *     scanfuzz [rounds [seed]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "scan.h"
+#include "tune.h"
+
+#define MAX_LEN	 (3 * SCAN_UNROLL * 4 + 7)
+#define NR_NEAR	 (9)
+#define NR_FIXED (4)
+
+/* bytes probed first as the target: zero, all ones, the high bit and one */
+static const u8 fixed[NR_FIXED] = {0x00, 0xff, 0x80, 0x01};
+
+/* aligned room for the longest buffer, four alignments and the bytes after */
+static u32 store[(MAX_LEN + 4 + 8) / 4 + 1];
+
+static u32 state = 1;
+static u32 cases;
+static u32 failures;
+
+/* xorshift32 */
+static u32 fuzzRandom(void)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+
+	return state;
+}
+
+/* a byte other than 'c' that is close to it in the SWAR arithmetic */
+static u8 fuzzNear(u8 c)
+{
+	u8 b;
+
+	do {
+		switch (fuzzRandom() % NR_NEAR) {
+		case 0: b = c ^ 0x01; break;
+		case 1: b = c + 1; break;
+		case 2: b = c - 1; break;
+		case 3: b = c ^ 0x80; break;
+		case 4: b = 0x00; break;
+		case 5: b = 0xff; break;
+		case 6: b = 0x80; break;
+		case 7: b = 0x01; break;
+		default: b = (u8)fuzzRandom(); break;
+		}
+	} while (b == c);
+
+	return b;
+}
+
+static u32 refFind(const u8 *buf, u32 len, const u8 *set, u32 nset)
+{
+	u32 i, j;
+
+	for (i = 0; i < len; i++) {
+		for (j = 0; j < nset; j++) {
+			if (buf[i] == set[j]) {
+				return i;
+			}
+		}
+	}
+
+	return len;
+}
+
+static u32 refCount(const u8 *buf, u32 len, u8 c)
+{
+	u32 n = 0;
+	u32 i;
+
+	for (i = 0; i < len; i++) {
+		n += (buf[i] == c);
+	}
+
+	return n;
+}
+
+static void fuzzCheck(const char *kernel, u32 align, u32 len, u8 c, u32 got,
+					  u32 want)
+{
+	cases++;
+	if (got == want) {
+		return;
+	}
+	failures++;
+	if (failures <= 10) {
+		printf("%s: align %u len %u byte 0x%02x: %u, expected %u\n", kernel,
+			   align, len, c, got, want);
+	}
+}
+
+/* one buffer: a match of 'c' at 'pos' ('len' for none) and one past the end */
+static void fuzzMatch(u32 align, u32 len, u32 pos, u8 c)
+{
+	u8 *buf = (u8 *)store + align;
+	u8 set[SCAN_SET_MAX];
+	const u8 *hit;
+	u32 nset, i;
+
+	for (i = 0; i < len + 8; i++) {
+		buf[i] = fuzzNear(c);
+	}
+	if (pos < len) {
+		buf[pos] = c;
+	}
+	buf[len] = c;
+
+	hit = scan_memchr(buf, c, len);
+	fuzzCheck("scan_memchr", align, len, c, (NULL != hit ? hit - buf : len),
+			  pos);
+	fuzzCheck("scan_count", align, len, c, scan_count(buf, len, c),
+			  (pos < len ? 1 : 0));
+	if (0 == c) {
+		fuzzCheck("scan_find_zero", align, len, c, scan_find_zero(buf, len),
+				  pos);
+		if (pos < len) {
+			fuzzCheck("scan_strlen", align, len, c, scan_strlen((char *)buf),
+					  pos);
+		}
+	}
+
+	/* the target among up to SCAN_SET_MAX bytes, the others may occur */
+	nset = 1 + fuzzRandom() % SCAN_SET_MAX;
+	for (i = 0; i < nset; i++) {
+		set[i] = (u8)fuzzRandom();
+	}
+	set[fuzzRandom() % nset] = c;
+	fuzzCheck("scan_find_any", align, len, c,
+			  scan_find_any(buf, len, set, nset),
+			  refFind(buf, len, set, nset));
+}
+
+/* one buffer with 'c' at random positions, counted */
+static void fuzzDense(u32 align, u32 len, u8 c)
+{
+	u8 *buf = (u8 *)store + align;
+	u32 i;
+
+	for (i = 0; i < len + 8; i++) {
+		buf[i] = (0 != (fuzzRandom() & 1) ? c : fuzzNear(c));
+	}
+	fuzzCheck("scan_count", align, len, c, scan_count(buf, len, c),
+			  refCount(buf, len, c));
+	fuzzCheck("scan_find_zero", align, len, c, scan_find_zero(buf, len),
+			  refFind(buf, len, (const u8 *)"", 1));
+}
+
+int main(int argc, char **argv)
+{
+	u32 rounds = (argc > 1 ? strtoul(argv[1], NULL, 0) : 64);
+	u32 round, align, len, pos;
+	u8 c;
+
+	if (argc > 2) {
+		state = strtoul(argv[2], NULL, 0) | 1;
+	}
+	for (round = 0; round < rounds; round++) {
+		c = (round < NR_FIXED ? fixed[round] : (u8)fuzzRandom());
+		for (align = 0; align < 4; align++) {
+			for (len = 0; len <= MAX_LEN; len++) {
+				for (pos = 0; pos <= len; pos++) {
+					fuzzMatch(align, len, pos, c);
+				}
+				fuzzDense(align, len, c);
+			}
+		}
+	}
+
+	printf("scanfuzz: SCAN_UNROLL %d, %u cases, %u failed\n", SCAN_UNROLL,
+		   cases, failures);
+
+	return (0 == failures ? 0 : 1);
+}
@@ -0,0 +1,137 @@
+from argparse import ArgumentParser
+from os import path
+import re
+import sys
+
+parser = ArgumentParser(description='Worst-case stack depth from -fcallgraph-info')
+parser.add_argument("output", help="generated linker script")
+parser.add_argument("objects", nargs="*", help="object files, *.ci is looked up next to them")
+parser.add_argument("--root", action="append", default=[], help="thread context entry (main, exports)")
+parser.add_argument("--isr", action="append", default=[], help="interrupt handler running on the internal stack")
+parser.add_argument("--irq-nesting", type=int, default=1, help="max number of nested interrupt levels")
+parser.add_argument("--entry-frame", type=int, default=0, help="bytes pushed by the startup veneer")
+parser.add_argument("--annotations", help="frames of asm/libgcc functions and targets of indirect calls")
+
+NODE = re.compile(r'node: \{ title: "([^"]+)" label: "([^"]*)"')
+EDGE = re.compile(r'edge: \{ sourcename: "([^"]+)" targetname: "([^"]+)"(?: label: "([^"]*)")?')
+USAGE = re.compile(r'(\d+) bytes \(([a-z,]+)\)')
+INDIRECT = "__indirect_call"
+
+class StackError(Exception):
+	pass
+
+def short_name(title):
+	# static functions are titled "file.c:name"
+	return title.rsplit(":", 1)[-1]
+
+def located(func, where):
+	# "file.c:line:column: name" if the call graph gave the source location
+	if func in where:
+		return "%s: %s" % (where[func], short_name(func))
+	return short_name(func)
+
+def parse_ci(ci_path, frames, calls, where):
+	with open(ci_path) as f:
+		for line in f:
+			m = NODE.match(line)
+			if m:
+				title, label = m.group(1), m.group(2)
+				usage = USAGE.search(label)
+				if usage is None:
+					continue
+				size, kind = int(usage.group(1)), usage.group(2)
+				if kind == "dynamic":
+					raise StackError("%s: unbounded dynamic stack (%s)" % (title, label.split("\\n")[1]))
+				frames[title] = max(frames.get(title, 0), size)
+				where[title] = label.split("\\n")[1]
+				calls.setdefault(title, set())
+				continue
+			m = EDGE.match(line)
+			if m:
+				calls.setdefault(m.group(1), set()).add(m.group(2))
+
+def parse_annotations(annot_path, frames, indirect):
+	with open(annot_path) as f:
+		for lineno, line in enumerate(f, 1):
+			words = line.split("#", 1)[0].split()
+			if not words:
+				continue
+			if len(words) == 3 and words[1] == "stack":
+				frames[words[0]] = int(words[2], 0)
+			elif len(words) >= 3 and words[1] == "calls":
+				indirect.setdefault(words[0], set()).update(words[2:])
+			else:
+				raise StackError("%s:%d: expected '<func> stack <bytes>' or '<func> calls <callee>...'" % (annot_path, lineno))
+
+def resolve(name, frames):
+	if name in frames:
+		return name
+	# direct calls reference static functions by their plain name
+	for title in frames:
+		if short_name(title) == name:
+			return title
+	return None
+
+def depth(func, frames, calls, indirect, where, memo, stack):
+	if func in memo:
+		return memo[func]
+	if func in stack:
+		cycle = stack[stack.index(func):] + [func]
+		raise StackError("unbounded recursion: %s" % " -> ".join(short_name(f) for f in cycle))
+	stack.append(func)
+	worst, path_ = 0, []
+	callees = set()
+	for callee in calls.get(func, ()):
+		if callee == INDIRECT:
+			targets = indirect.get(short_name(func))
+			if targets is None:
+				raise StackError("%s: indirect call without annotation" % located(func, where))
+			callees.update(targets)
+		else:
+			callees.add(callee)
+	for callee in callees:
+		title = resolve(callee, frames)
+		if title is None:
+			raise StackError("%s: unknown stack usage of callee %s" % (located(func, where), callee))
+		d, p = depth(title, frames, calls, indirect, where, memo, stack)
+		if d > worst:
+			worst, path_ = d, p
+	stack.pop()
+	memo[func] = (frames[func] + worst, [func] + path_)
+	return memo[func]
+
+def analyse(args):
+	frames, calls, indirect, where = {}, {}, {}, {}
+	for obj in args.objects:
+		ci = path.splitext(obj)[0] + ".ci"
+		if path.exists(ci):
+			parse_ci(ci, frames, calls, where)
+	if args.annotations:
+		parse_annotations(args.annotations, frames, indirect)
+
+	memo = {}
+	def report(name):
+		title = resolve(name, frames)
+		if title is None:
+			raise StackError("%s: no call graph information" % name)
+		d, p = depth(title, frames, calls, indirect, where, memo, [])
+		print("  %-24s %6d  %s" % (name, d, " -> ".join(short_name(f) for f in p)))
+		return d
+
+	print("stack depth (bytes) per entry:")
+	thread = max([report(r) for r in args.root] or [0])
+	isrs = sorted([report(i) for i in args.isr], reverse=True)
+	total = args.entry_frame + thread + sum(isrs[:args.irq_nesting])
+	return (total + 7) & ~7
+
+if __name__ == "__main__":
+	args = parser.parse_args()
+	try:
+		size = analyse(args)
+	except StackError as e:
+		print("stackdepth: error: %s" % e, file=sys.stderr)
+		sys.exit(1)
+	print("internal stack: %d bytes" % size)
+	with open(args.output, "w") as f:
+		f.write("/* generated by scripts/stackdepth.py, do not edit */\n")
+		f.write("__stack_size__ = 0x%x;\n" % size)
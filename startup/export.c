@@ -0,0 +1,62 @@
+/**
+ * @file
+ *
+ * Per-export call statistics, updated by __pic_enter (startup.S) around
+ * each call into the blob.
+ */
+
+#include <stdbool.h>
+
+#include "export.h"
+#include "histogram.h"
+#include "mmu.h"
+#include "timer.h"
+
+/* duration of every call into the blob, whichever export */
+HISTOGRAM(export_latency, "export");
+
+/**
+ * Called on the internal stack before the exported function. The timer is
+ * started on the first call, unless the host already runs it. With PIC_MMU
+ * the blob's page table is switched in first (mmu.h).
+ *
+ * @return current value of the export timer
+ */
+u32 export_begin(void)
+{
+#if defined(PIC_MMU)
+	mmu_enter();
+#endif
+	if (!timer_isEnabled(EXPORT_TIMER_NR, EXPORT_TIMER_CTR)) {
+		timer_init(EXPORT_TIMER_NR, EXPORT_TIMER_CTR);
+		timer_start(EXPORT_TIMER_NR, EXPORT_TIMER_CTR);
+	}
+
+	return timer_getValue(EXPORT_TIMER_NR, EXPORT_TIMER_CTR);
+}
+
+/**
+ * Called on the internal stack after the exported function has returned.
+ *
+ * @param exp - record of the export
+ * @param start - timer value returned by export_begin()
+ * @param ret - value returned by the exported function
+ */
+void export_end(struct pic_export *exp, u32 start, s32 ret)
+{
+	/* the timer counts down, see timer_getValue() */
+	u32 ticks = start - timer_getValue(EXPORT_TIMER_NR, EXPORT_TIMER_CTR);
+
+	exp->calls++;
+	exp->ticks += ticks;
+	if (ticks > exp->ticks_max) {
+		exp->ticks_max = ticks;
+	}
+	if (ret < 0) {
+		exp->last_error = ret;
+	}
+	histogram_record(&export_latency, ticks);
+#if defined(PIC_MMU)
+	mmu_leave();
+#endif
+}
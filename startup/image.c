@@ -0,0 +1,47 @@
+/**
+ * @file
+ *
+ * Check of the image digest, see image.h.
+ */
+
+#include <stddef.h>
+
+#include "image.h"
+#include "import.h"
+
+/**
+ * Hashes the read-only part of the loaded image and compares the result with
+ * the digest in the image header. The image must have been initialized
+ * (__pic_base is its load address), i.e. be called through an export.
+ *
+ * @return 0 if the digest matches, -1 otherwise
+ */
+int image_verify(void)
+{
+	static const u8 zeros[SHA256_DIGEST_SIZE];
+	const struct pic_image_header *hdr = &__image_header;
+	const u8 *base = (const u8 *)__pic_base;
+	const u8 *field = hdr->digest;
+	u8 digest[SHA256_DIGEST_SIZE];
+	struct sha256 ctx;
+	u32 i;
+
+	if (IMAGE_MAGIC != hdr->magic) {
+		return -1;
+	}
+
+	sha256_init(&ctx);
+	sha256_update(&ctx, base, field - base);
+	sha256_update(&ctx, zeros, SHA256_DIGEST_SIZE);
+	sha256_update(&ctx, field + SHA256_DIGEST_SIZE,
+				  hdr->ro_size - (field + SHA256_DIGEST_SIZE - base));
+	sha256_final(&ctx, digest);
+
+	for (i = 0; i < SHA256_DIGEST_SIZE; i++) {
+		if (digest[i] != field[i]) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
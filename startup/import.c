@@ -0,0 +1,73 @@
+/**
+ * @file
+ *
+ * Load time resolution of the functions imported from a shared blob.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "import.h"
+
+u32 __pic_lib __attribute__((section(".data.pic_lib"))) = 0;
+
+typedef struct pic_export_table *(*pic_lib_entry)(void);
+
+/* Target of the imports that could not be resolved */
+static int pic_unresolved(void) { return -1; }
+
+static bool pic_name_equal(const char *a, const char *b)
+{
+	while (*a == *b) {
+		if ('\0' == *a) {
+			return true;
+		}
+		a++;
+		b++;
+	}
+
+	return false;
+}
+
+/**
+ * Called by __pic_enter (startup.S) once per load address, after the
+ * relocation. Initializes the shared blob at __pic_lib by calling it, then
+ * looks every import up by name in the blob's export table.
+ *
+ * @return 0 on success, -1 if an import is missing; its calls then return -1
+ */
+int pic_import_resolve(void)
+{
+	struct pic_export_table *table;
+	struct pic_import *imp;
+	int ret = 0;
+
+	if (&__imports_start__[0] == &__imports_end__[0]) {
+		return 0;
+	}
+
+	for (imp = __imports_start__; imp < __imports_end__; imp++) {
+		imp->slot = (u32)pic_unresolved;
+	}
+	if (0 == __pic_lib) {
+		return -1;
+	}
+
+	table = ((pic_lib_entry)__pic_lib)();
+	for (imp = __imports_start__; imp < __imports_end__; imp++) {
+		const char *name = (const char *)(__pic_base + imp->name);
+		struct pic_export *exp;
+
+		for (exp = table->start; exp < table->end; exp++) {
+			if (pic_name_equal(name, (const char *)(__pic_lib + exp->name))) {
+				imp->slot = __pic_lib + exp->func;
+				break;
+			}
+		}
+		if (exp == table->end) {
+			ret = -1;
+		}
+	}
+
+	return ret;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file
+ *
+ * Flat page table of the blob, see mmu.h. mmu_enter() and mmu_leave() are
+ * called around each export by export_begin() and export_end().
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bsp.h"
+#include "cache.h"
+#include "mmu.h"
+#include "vectors.h"
+
+#if defined(PIC_HIGH_VECTORS)
+/*
+ * Room to align the level 1 table to 16KB, followed by the coarse tables of
+ * the device and the vector sections and, 4KB aligned, the vector page
+ */
+static u32 mmu_mem[(2 * MMU_L1_SIZE + 2 * MMU_PAGE_SIZE) / 4];
+#else
+/* Room to align the level 1 table to 16KB, followed by the coarse table */
+static u32 mmu_mem[(2 * MMU_L1_SIZE + MMU_L2_SIZE) / 4];
+#endif
+
+/* NULL until built, the table is rebuilt when the blob is moved (bss cleared) */
+static u32 *mmu_l1;
+
+/* calls active, only the outermost one switches the table (calls nest, see startup.S) */
+static u32 mmu_depth;
+
+/* host state restored by mmu_leave() */
+static bool mmu_owned;
+static u32 mmu_ctrl;
+static u32 mmu_ttbr;
+static u32 mmu_dacr;
+
+/* Pages of the device section mapped bufferable */
+static const u32 mmu_buffered[] = {
+#define CAST_ADDR(ADDR) (ADDR),
+	BSP_UART_BASE_ADDRESSES(CAST_ADDR)
+#undef CAST_ADDR
+	BSP_DMAC_BASE_ADDRESS,
+};
+
+#define SECTION(addr) ((addr) >> 20)
+#define PAGE(addr)	  (((addr) >> 12) & (MMU_L2_ENTRIES - 1))
+
+#if defined(PIC_HIGH_VECTORS)
+/*
+ * Maps the vector page alone in the last section. Every vector loads its
+ * target from the second half of the page: the host's own vector in the
+ * flat mapped low page, the blob's entry for IRQs.
+ */
+static void mmu_buildVectors(u32 *l1)
+{
+	u32 *l2 = l1 + MMU_L1_ENTRIES + MMU_L2_ENTRIES;
+	u32 *page = l1 + (MMU_L1_SIZE + MMU_PAGE_SIZE) / 4;
+	u32 i;
+
+	for (i = 0; i < MMU_L2_ENTRIES; i++) {
+		l2[i] = 0;
+	}
+	l2[PAGE(MMU_HIGH_VECTORS)] = (u32)page | MMU_SMALL_AP | MMU_L2_SMALL;
+	l1[SECTION(MMU_HIGH_VECTORS)] = (u32)l2 | MMU_L1_COARSE;
+
+	for (i = 0; i < 8; i++) {
+		page[i] = VECTORS_LDR_PC;
+		page[8 + i] = i * 4;
+	}
+	page[8 + VECTORS_IRQ] = (u32)pic_irq_vector;
+}
+#endif
+
+static void mmu_build(void)
+{
+	u32 *l1 = (u32 *)(((u32)mmu_mem + MMU_L1_SIZE - 1) & ~(MMU_L1_SIZE - 1));
+	u32 *l2 = l1 + MMU_L1_ENTRIES;
+	u32 dev = SECTION(BSP_DMAC_BASE_ADDRESS);
+	u32 i;
+
+	for (i = 0; i < MMU_L1_ENTRIES; i++) {
+		l1[i] = (i << 20) | MMU_SECTION_AP | MMU_L1_SECTION;
+		if ((i << 20) < MMU_RAM_END) {
+			l1[i] |= MMU_C | MMU_B;
+		}
+	}
+
+	/* the UARTs and the DMA controller share a section with the VIC and the
+	 * timers, which stay strongly ordered */
+	for (i = 0; i < MMU_L2_ENTRIES; i++) {
+		l2[i] = (dev << 20) | (i << 12) | MMU_SMALL_AP | MMU_L2_SMALL;
+	}
+	for (i = 0; i < sizeof(mmu_buffered) / sizeof(mmu_buffered[0]); i++) {
+		/* all of them lie in the device section */
+		l2[PAGE(mmu_buffered[i])] |= MMU_B;
+	}
+	l1[dev] = (u32)l2 | MMU_L1_COARSE;
+
+#if defined(PIC_HIGH_VECTORS)
+	mmu_buildVectors(l1);
+#endif
+	mmu_l1 = l1;
+}
+
+/**
+ * Switches to the blob's page table unless the host already runs with the
+ * MMU on. The D-cache stays off, so nothing has to be cleaned on leave.
+ * With PIC_HIGH_VECTORS the same write moves the vectors to the blob's page.
+ */
+void mmu_enter(void)
+{
+	u32 ctrl;
+
+	if (0 != mmu_depth++) {
+		return;
+	}
+	__asm__ volatile("mrc p15, 0, %0, c1, c0, 0" : "=r"(ctrl));
+	mmu_owned = (0 == (ctrl & MMU_CTRL_M));
+	if (!mmu_owned) {
+		return;
+	}
+	if (NULL == mmu_l1) {
+		mmu_build();
+	}
+
+	mmu_ctrl = ctrl;
+	__asm__ volatile("mrc p15, 0, %0, c2, c0, 0" : "=r"(mmu_ttbr));
+	__asm__ volatile("mrc p15, 0, %0, c3, c0, 0" : "=r"(mmu_dacr));
+
+	/* domain 0 client: the access permissions are checked */
+	__asm__ volatile("mcr p15, 0, %0, c3, c0, 0" : : "r"(1));
+	__asm__ volatile("mcr p15, 0, %0, c2, c0, 0" : : "r"(mmu_l1) : "memory");
+	__asm__ volatile("mcr p15, 0, %0, c8, c7, 0" : : "r"(0));
+	ctrl = (ctrl | MMU_CTRL_M) & ~MMU_CTRL_C;
+#if defined(PIC_HIGH_VECTORS)
+	ctrl |= MMU_CTRL_V;
+#endif
+	__asm__ volatile("mcr p15, 0, %0, c1, c0, 0" : : "r"(ctrl) : "memory");
+}
+
+/**
+ * Returns to the host's translation state once all posted writes completed.
+ */
+void mmu_leave(void)
+{
+	if (0 != --mmu_depth || !mmu_owned) {
+		return;
+	}
+	mmu_owned = false;
+
+	cache_drain_write_buffer();
+	__asm__ volatile("mcr p15, 0, %0, c1, c0, 0" : : "r"(mmu_ctrl) : "memory");
+	__asm__ volatile("mcr p15, 0, %0, c2, c0, 0" : : "r"(mmu_ttbr));
+	__asm__ volatile("mcr p15, 0, %0, c3, c0, 0" : : "r"(mmu_dacr));
+	__asm__ volatile("mcr p15, 0, %0, c8, c7, 0" : : "r"(0));
+}
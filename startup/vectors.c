@@ -0,0 +1,76 @@
+/**
+ * @file
+ *
+ * Dispatch of the IRQs taken through the blob's high vector page, see
+ * vectors.h.
+ */
+
+#include <stddef.h>
+
+#include "bsp.h"
+#include "vectors.h"
+
+/* handler of every line, NULL if the host handles it */
+static void (*vectors_isr[VECTORS_NR_IRQS])(void);
+
+/* lines with a handler, of the primary controller and of the SIC */
+static u32 vectors_pic;
+static u32 vectors_sic;
+
+/**
+ * Installs or removes the handler of a line. Takes effect on the next IRQ,
+ * nothing else is touched.
+ *
+ * @param irq - line of the primary controller, or VECTORS_SIC_IRQ(line)
+ * @param isr - handler, NULL to leave the line to the host again
+ */
+void vectors_install(u32 irq, void (*isr)(void))
+{
+	u32 *mask = (irq < 32 ? &vectors_pic : &vectors_sic);
+
+	if (irq >= VECTORS_NR_IRQS) {
+		return;
+	}
+
+	vectors_isr[irq] = isr;
+	if (NULL != isr) {
+		*mask |= 1u << (irq & 31);
+	} else {
+		*mask &= ~(1u << (irq & 31));
+	}
+}
+
+/**
+ * Exported IRQ handler entered from the high vector page. Lines that stay
+ * pending after it returns, the host's ones, enter it again and are passed
+ * on to the host.
+ *
+ * @return 0 if handlers were called, VECTORS_EHOST if no pending line has
+ * one
+ */
+int pic_irq(void)
+{
+	u32 status =
+		*(volatile const u32 *)(BSP_PIC_BASE_ADDRESS + BSP_PIC_IRQSTATUS);
+	u32 pending[2] = {status & vectors_pic, 0};
+	u32 i, line;
+
+	if (0 != (status & 1u << BSP_PIC_SIC_IRQ)) {
+		pending[1] = *(volatile const u32 *)(BSP_SIC_BASE_ADDRESS +
+											 BSP_SIC_STATUS) &
+					 vectors_sic;
+	}
+	if (0 == (pending[0] | pending[1])) {
+		return VECTORS_EHOST;
+	}
+
+	for (i = 0; i < 2; i++) {
+		while (0 != pending[i]) {
+			line = 31 - __builtin_clz(pending[i]);
+			pending[i] &= ~(1u << line);
+			vectors_isr[i * 32 + line]();
+		}
+	}
+
+	return 0;
+}